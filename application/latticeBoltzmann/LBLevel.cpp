@@ -27,12 +27,17 @@ void LBLevel::advance()
     {
       FArrayBox& f = fi()[dit];
       FArrayBox& U = m_U[dit];
+      // Stream the boxes through memory if allocated from files
+      fi().prefetch(dit);
+      m_U.prefetch(dit);
       
+      m_loadBalancer.startTimer(*dit);
       LBPatch::collision(f, U, m_tau);
+      m_loadBalancer.stopTimer(*dit);
     }
 
   // Set intiterior and periodic ghost cells
-  fi().exchange(m_copier);
+  m_f.exchange();
   
   // Set bounce back, stream, compute macroscopic
   for (DataIterator dit(m_dbl); dit.ok(); ++dit)
@@ -40,13 +45,18 @@ void LBLevel::advance()
       FArrayBox& f = fi()[dit];
       FArrayBox& fhat = fihat()[dit];
       FArrayBox& U = m_U[dit];
+      fi().prefetch(dit);
+      fihat().prefetch(dit);
+      m_U.prefetch(dit);
       
+      m_loadBalancer.startTimer(*dit);
       setBounceBack(f);
       LBPatch::stream(f, fhat); // stream f into fhat
       LBPatch::macroscopic(fhat, U);
+      m_loadBalancer.stopTimer(*dit);
     }
 
-     m_b = !m_b; // swap so f1 is newest after stream
+     m_f.rotate(); // fhat is newest after stream
 
  
 }
@@ -54,6 +64,26 @@ void LBLevel::advance()
 
 
 
+/*--------------------------------------------------------------------*/
+//  Redistribute boxes based on measured cost
+/** Costs are measured in advance() since the last call.  All LevelData
+ *  and the copier are moved to the new layout.
+ *  \param[in]  a_tolerance
+ *                      Redistribute if the maximum cost on a process
+ *                      exceeds the mean by this factor
+ *  \return             T - boxes were redistributed
+ *//*-----------------------------------------------------------------*/
+
+bool LBLevel::rebalance(const Real a_tolerance)
+{
+  const bool redistributed = m_loadBalancer.rebalance(a_tolerance);
+  if (redistributed)
+    {
+      m_dbl = m_loadBalancer.disjointBoxLayout();
+    }
+  return redistributed;
+}
+
 /*--------------------------------------------------------------------*/
 //  Plot to CGNS
 /** Plot the current data
@@ -201,33 +231,11 @@ void LBLevel::setBounceBack(BaseFab<Real>& a_f)
 
 /*--------------------------------------------------------------------*/
 //  Compute mass in domain
-/** Just a sum of fi()
- *  \return             Total mass in domain in process 0
+/** Just a sum of fi() over the valid cells
+ *  \return             Total mass in domain on all processes
  *//*-----------------------------------------------------------------*/
 
 Real LBLevel::computeTotalMass()
 {
-  Real localDomainMass = 0.; 
-  for (DataIterator dit(m_dbl); dit.ok(); ++dit)  //**FIX m_boxes
-    {
-      const Box& box = m_dbl[dit];
-      MD_ARRAY_RESTRICT(arrfi, fi()[dit]);  //**FIX method to access current fi
-      for (int iVel = 0; iVel != LBParameters::g_numVelDir; ++iVel)
-        {
-          MD_BOXLOOP_OMP(box, i)
-            {
-              localDomainMass += arrfi[MD_IX(i, iVel)];
-            }
-        } 
-     } 
-  Real globalDomainMass = localDomainMass; 
-#ifdef USE_MPI
-  // Accumulated the result into process 0
-  MPI_Reduce(&localDomainMass, &globalDomainMass, 1, BXFR_MPI_REAL, MPI_SUM, 0,
-             MPI_COMM_WORLD);
-#endif
-                            
-return globalDomainMass;
-
-
+  return fi().sum(0, LBParameters::g_numVelDir);
 }
@@ -19,6 +19,7 @@
 #include "LBLevel.H"
 #include "IntVect.H"
 #include "Stopwatch.H"
+#include "LinuxSupport.H"
 #include <iostream>
 #include <chrono>
 // Don't forget to configure with --enable-release
@@ -54,6 +55,10 @@ int main(int argc, const char* argv[])
       std::cout << "Domain size: " << domain.dimensions() << std::endl;
       std::cout << "Running with " << maxTime << " timesteps." << std::endl;
       std::cout << "Number of local boxes: " << dbl.localSize() << std::endl;
+      const System::HugePageCounters counters = System::hugePageCounters();
+      std::cout << "Bytes on huge pages (hugetlb, transparent): "
+                << counters.bytesHugetlb << ", " << counters.bytesAdvised
+                << std::endl;
     }
 
   if (masterProc) {stopwatch.start();}
@@ -71,6 +76,13 @@ int main(int argc, const char* argv[])
             }
         }
       level.advance();
+      if (t % 400 == 399)
+        {
+          if (level.rebalance() && masterProc)
+            {
+              std::cout << "Redistributed boxes at t = " << t << std::endl;
+            }
+        }
     }
   if (masterProc) {stopwatch.stop();}
       
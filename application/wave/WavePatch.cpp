@@ -15,6 +15,7 @@
 #include "cgnslib.h"
 
 #include "BaseFabMacros.H"
+#include "BaseFabExpr.H"
 #include "WavePatch.H"
 #ifdef USE_GPU
 #include "WavePatch_Cuda.H"
@@ -60,22 +61,18 @@ WavePatch::WavePatch(const Box&        a_domain,
   m_dx(a_dx),
   m_dt(a_dx*a_cfl/a_c),
   m_time((Real)0.),
-  m_iteration(0),
-  m_idxStep(0),
-  m_idxStepUpdate(1),
-  m_idxStepOld(2)
+  m_iteration(0)
 {
-  m_u[0].define(m_boxes, 1, 1);
-  m_u[1].define(m_boxes, 1, 1);
-  m_u[2].define(m_boxes, 1, 1);
+  m_u.define(m_boxes, 1, 1);
   DataIterator dit(m_boxes);
   m_bidx = *dit;
 #ifdef USE_GPU
   // Pack the BaseFabs for each time index into an array
   const BaseFab<Real>* patchData[3];
-  patchData[0] = &(m_u[0][m_bidx]);
-  patchData[1] = &(m_u[1][m_bidx]);
-  patchData[2] = &(m_u[2][m_bidx]);
+  for (int idx = 0; idx != 3; ++idx)
+    {
+      patchData[idx] = &(m_u.slot(idx)[m_bidx]);
+    }
   WavePatch_Cuda::construct(m_domain,
                             patchData,
                             m_cudaFab_device,
@@ -150,7 +147,7 @@ WavePatch::advance()
 
 #ifdef USE_GPU
   un().copyToDevice();
-  WavePatch_Cuda::driverBC(m_numBlkBC, m_idxStep);
+  WavePatch_Cuda::driverBC(m_numBlkBC, currentStepIndex());
   un().copyToHost();
 #else
   for (int dir = 0; dir != g_SpaceDim; ++dir)
@@ -173,17 +170,17 @@ WavePatch::advance()
   un().copyToDevice();
   unm1().copyToDevice();
   WavePatch_Cuda::driverRHS(m_numBlkRHS,
-                            m_idxStep,
-                            m_idxStepUpdate,
-                            m_idxStepOld,
+                            currentStepIndex(),
+                            m_u.index(2),
+                            oldStepIndex(),
                             factor);
   unp1().copyToHost();
 #else
+
+#ifdef USE_VEX
   MD_ARRAY_RESTRICT(arrunp1, unp1());
   MD_ARRAY_RESTRICT(arrun, un());
   MD_ARRAY_RESTRICT(arrunm1, unm1());
-
-#ifdef USE_VEX
   const __mvr two_vr = _mm_vr(set1)(2.0);
   const __mvr factor_vr = _mm_vr(set1)(factor);
   MD_BOXLOOP_PENCIL_OMP(m_domain, i)
@@ -223,25 +220,18 @@ WavePatch::advance()
     }
 #else
 
-  // Time terms
+  // Time terms and Laplacian in a single pass
   {
-    MD_BOXLOOP_OMP(m_domain, i)
+    const auto u = FabExpr::term(un());
+    const auto d2 =
+      [&u](const int a_dir)
       {
-        arrunp1[MD_IX(i, 0)] = 2*arrun[MD_IX(i, 0)] - arrunm1[MD_IX(i, 0)];
-      }
+        return u.shift(a_dir, 1) - 2*u + u.shift(a_dir, -1);
+      };
+    FabExpr::assign(unp1(), m_domain, 0,
+                    2*u - FabExpr::term(unm1()) +
+                    factor*(D_TERM(d2(0), + d2(1), + d2(2))));
   }
-
-  // Laplacian
-  for (int dir = 0; dir != g_SpaceDim; ++dir)
-    {
-      const int MD_ID(o, dir);
-      MD_BOXLOOP_OMP(m_domain, i)
-        {
-          arrunp1[MD_IX(i, 0)] += factor*(arrun[MD_OFFSETIX(i,+,o, 0)] -
-                                          2*arrun[MD_IX(i, 0)] +
-                                          arrun[MD_OFFSETIX(i,-,o, 0)]);
-        }         
-    }
 #endif  /* !VEX */
 #endif  /* !GPU */
 
@@ -266,15 +256,24 @@ WavePatch::advanceIterGroup(const int   a_numIter,
 {
   m_timerAdvance.start();
   const Real factor = std::pow(m_dt*m_c/m_dx, 2)/g_SpaceDim;
+  // The driver rotates the indices once per iteration
+  int idxStep       = currentStepIndex();
+  int idxStepUpdate = m_u.index(2);
+  int idxStepOld    = oldStepIndex();
   WavePatch_Cuda::driverAdvanceIterGroup(a_numIter,
                                          m_numBlkBC,
                                          m_numBlkRHS,
-                                         m_idxStep,
-                                         m_idxStepUpdate,
-                                         m_idxStepOld,
+                                         idxStep,
+                                         idxStepUpdate,
+                                         idxStepOld,
                                          factor,
                                          a_cuEvent_iterGroupStart,
                                          a_cuEvent_iterGroupEnd);
+  for (int iter = 0; iter != a_numIter; ++iter)
+    {
+      advanceStepIndex();
+    }
+  CH_assert(currentStepIndex() == idxStep);
   m_iteration += a_numIter;
   m_time += a_numIter*m_dt;
   m_timerAdvance.stop();
@@ -286,7 +285,7 @@ WavePatch::advanceIterGroup(const int   a_numIter,
 /** Write un().
  *  \param[in]  a_idxStep
  *                      Index of solution in time to write (current is
- *                      given by m_idxStep)
+ *                      given by currentStepIndex())
  *  \param[in]  a_iteration
  *                      Index of iteration to write
  *  \return             -1 Error
@@ -346,10 +345,10 @@ WavePatch::writePlotFile(const int a_idxStep, const int a_iteration) const
   
   // Write the solution data
   static const char *const stateNames[] = { "displacement" };
-  cgerr = m_u[a_idxStep].writeCGNSSolData(indexFile,
-                                          indexBase,
-                                          indexZoneOffset,
-                                          stateNames);
+  cgerr = m_u.slot(a_idxStep).writeCGNSSolData(indexFile,
+                                               indexBase,
+                                               indexZoneOffset,
+                                               stateNames);
   if (cgerr)
     {
       std::cout << "EE Failed to write solution for box " << cgerr-1 << '!'
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <vector>
 
 #include "LinuxSupport.H"
 #include "IntVect.H"
@@ -189,6 +190,20 @@ int main(int argc, const char* argv[])
 
   patchSolver.initialData();
 
+#ifdef _OPENMP
+  // Pages of the solution on each NUMA node (placed by first touch)
+  {
+    std::vector<int> numPageNode;
+    const BaseFab<Real>& un = patchSolver.un();
+    if (System::pageNodes(un.dataPtr(), un.sizeBytes(), numPageNode) >= 0)
+      {
+        std::cout << std::left << std::setw(40) << "Pages on NUMA nodes: ";
+        for (const int n : numPageNode) std::cout << n << ' ';
+        std::cout << std::endl << std::endl;
+      }
+  }
+#endif
+
 //--Write the first plot file if numIter == 0
 
   if (numIter == 0)
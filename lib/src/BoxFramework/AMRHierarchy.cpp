@@ -0,0 +1,442 @@
+
+/******************************************************************************/
+/**
+ * \file AMRHierarchy.cpp
+ *
+ * \brief Non-inline definitions for classes in AMRHierarchy.H
+ *
+ *//*+*************************************************************************/
+
+#include <algorithm>
+
+#include "AMRHierarchy.H"
+#include "BoxIterator.H"
+
+
+/*******************************************************************************
+ *
+ * Class AMRHierarchy: member definitions
+ *
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------*/
+//  Default constructor
+/*--------------------------------------------------------------------*/
+
+AMRHierarchy::AMRHierarchy()
+  :
+  m_levels(),
+  m_ncomp(0),
+  m_nghost(0)
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor
+/** \param[in]  a_baseDbl
+ *                      Layout of level 0 (covering the domain)
+ *  \param[in]  a_ncomp Number of components on all levels
+ *  \param[in]  a_nghost
+ *                      Number of ghost cells on all levels
+ *//*-----------------------------------------------------------------*/
+
+AMRHierarchy::AMRHierarchy(const DisjointBoxLayout& a_baseDbl,
+                           const int                a_ncomp,
+                           const int                a_nghost)
+{
+  define(a_baseDbl, a_ncomp, a_nghost);
+}
+
+/*--------------------------------------------------------------------*/
+//  Weak construction (removes all levels)
+/** \param[in]  a_baseDbl
+ *                      Layout of level 0 (covering the domain)
+ *  \param[in]  a_ncomp Number of components on all levels
+ *  \param[in]  a_nghost
+ *                      Number of ghost cells on all levels
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::define(const DisjointBoxLayout& a_baseDbl,
+                     const int                a_ncomp,
+                     const int                a_nghost)
+{
+  CH_assert(a_ncomp > 0);
+  CH_assert(a_nghost >= 0);
+  m_ncomp = a_ncomp;
+  m_nghost = a_nghost;
+  m_levels.clear();
+  std::unique_ptr<Level> level(new Level);
+  level->dbl = a_baseDbl;
+  level->refRatio = 1;
+  level->time = 0.;
+  level->timeOld = 0.;
+  level->data.reset(new LevelData<FArrayBox>(a_baseDbl, m_ncomp, m_nghost));
+  level->dataOld.reset(
+    new LevelData<FArrayBox>(a_baseDbl, m_ncomp, m_nghost));
+  level->copier.defineExchangeLD(*level->data);
+  m_levels.push_back(std::move(level));
+}
+
+/*--------------------------------------------------------------------*/
+//  Add a finer level
+/** The new level starts at the time of the next coarser level.  Its
+ *  data is not initialized.
+ *  \param[in]  a_dbl   Layout of the new level.  The domain must be
+ *                      the domain of the current finest level refined
+ *                      by a_refRatio.
+ *  \param[in]  a_refRatio
+ *                      Refinement ratio from the current finest level
+ *  \return             Index of the new level
+ *//*-----------------------------------------------------------------*/
+
+int
+AMRHierarchy::addLevel(const DisjointBoxLayout& a_dbl, const int a_refRatio)
+{
+  CH_assert(numLevel() > 0);
+  CH_assert(a_refRatio > 0);
+  const Level& crLevel = *m_levels.back();
+  Box domain = crLevel.dbl.problemDomain();
+  domain.refine(a_refRatio);
+  CH_assert(a_dbl.problemDomain() == domain);
+  (void)domain;
+  for (LayoutIterator lit(a_dbl); lit.ok(); ++lit)
+    {
+      CH_assert(a_dbl[lit].coarsenable(a_refRatio));
+    }
+
+  std::unique_ptr<Level> level(new Level);
+  level->dbl = a_dbl;
+  level->refRatio = a_refRatio;
+  level->time = crLevel.time;
+  level->timeOld = crLevel.time;
+  level->data.reset(new LevelData<FArrayBox>(a_dbl, m_ncomp, m_nghost));
+  level->dataOld.reset(new LevelData<FArrayBox>(a_dbl, m_ncomp, m_nghost));
+  level->copier.defineExchangeLD(*level->data);
+  // Ghost cells need coarse cells under them plus one more for slopes
+  level->ghostCopier.define(crLevel.dbl, a_dbl, a_refRatio,
+                            (m_nghost + a_refRatio - 1)/a_refRatio + 1);
+  level->ghostCopier.defineBuffers(level->ghostBuffer, m_ncomp);
+  level->ghostCopier.defineBuffers(level->ghostBufferOld, m_ncomp);
+  level->averageCopier.define(crLevel.dbl, a_dbl, a_refRatio, 0);
+  level->averageCopier.defineBuffers(level->averageBuffer, m_ncomp);
+  m_levels.push_back(std::move(level));
+  return numLevel() - 1;
+}
+
+/*--------------------------------------------------------------------*/
+//  Remove all levels finer than a given level
+/** \param[in]  a_numLevel
+ *                      Number of levels to keep (> 0)
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::truncate(const int a_numLevel)
+{
+  CH_assert(a_numLevel > 0);
+  if (a_numLevel < numLevel())
+    {
+      m_levels.resize(a_numLevel);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Set the time of the data on all levels
+/** \param[in]  a_time  Time of both the old and new data
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::setTime(const Real a_time)
+{
+  for (auto& level : m_levels)
+    {
+      level->time = a_time;
+      level->timeOld = a_time;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Average the new data on a level onto the next coarser level
+/** Coarse cells covered by the level are replaced (collective)
+ *  \param[in]  a_lvl   Fine level (> 0)
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::averageDown(const int a_lvl)
+{
+  CH_assert(a_lvl > 0 && a_lvl < numLevel());
+  Level& level = *m_levels[a_lvl];
+  const LevelData<FArrayBox>& fnData = *level.data;
+  for (DataIterator dit(level.dbl); dit.ok(); ++dit)
+    {
+      FArrayBox& avgFab = level.averageBuffer[(*dit).localIndex()];
+      averageFab(fnData[dit], level.refRatio, avgFab.box(), avgFab);
+    }
+  level.averageCopier.copyToCoarse(level.averageBuffer,
+                                   *m_levels[a_lvl - 1]->data);
+}
+
+/*--------------------------------------------------------------------*/
+//  Average the new data on all levels, finest first
+/*--------------------------------------------------------------------*/
+
+void
+AMRHierarchy::averageDownAll()
+{
+  for (int lvl = numLevel() - 1; lvl > 0; --lvl)
+    {
+      averageDown(lvl);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Fill the ghost cells of data on a level at a time
+/** Ghost cells inside the domain are first interpolated from the next
+ *  coarser level and then those covered by other boxes on the level
+ *  are exchanged (collective).  Ghost cells outside the domain are
+ *  not modified.
+ *  \param[in]  a_lvl   Level
+ *  \param[in]  a_data  Data on the level (new or old)
+ *  \param[out] a_data  Ghost cells filled
+ *  \param[in]  a_time  Time of a_data.  Must be between the old and
+ *                      new times of the next coarser level.
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::fillGhosts(const int             a_lvl,
+                         LevelData<FArrayBox>& a_data,
+                         const Real            a_time)
+{
+  CH_assert(a_lvl >= 0 && a_lvl < numLevel());
+  Level& level = *m_levels[a_lvl];
+  CH_assert(a_data.disjointBoxLayout().tag() == level.dbl.tag());
+  if (a_lvl > 0 && m_nghost > 0)
+    {
+      const Level& crLevel = *m_levels[a_lvl - 1];
+
+      // Coarse data at a_time, linear in time between old and new
+      Real alpha = 1.;
+      const Real dtCr = crLevel.time - crLevel.timeOld;
+      if (dtCr > 0.)
+        {
+          alpha = std::min((Real)1., std::max((Real)0.,
+                                             (a_time - crLevel.timeOld)/dtCr));
+        }
+      if (alpha > 0.)
+        {
+          level.ghostCopier.copyToFine(*crLevel.data, level.ghostBuffer);
+        }
+      if (alpha < 1.)
+        {
+          level.ghostCopier.copyToFine(*crLevel.dataOld, level.ghostBufferOld);
+          if (alpha > 0.)
+            {
+              for (int i = 0, i_end = level.ghostBuffer.size(); i != i_end;
+                   ++i)
+                {
+                  Real* p = level.ghostBuffer[i].dataPtr();
+                  const Real* pOld = level.ghostBufferOld[i].dataPtr();
+                  // Both buffers have the same layout, including padding
+                  for (int j = 0, j_end = level.ghostBuffer[i].ncomp()*
+                         level.ghostBuffer[i].getComponentStride();
+                       j != j_end; ++j)
+                    {
+                      p[j] = alpha*p[j] + (1. - alpha)*pOld[j];
+                    }
+                }
+            }
+        }
+      const std::vector<FArrayBox>& crBuffer =
+        (alpha > 0.) ? level.ghostBuffer : level.ghostBufferOld;
+
+      // Interpolate to the ghost cells around each box, as disjoint slabs
+      // on each side
+      const Box& domain = level.dbl.problemDomain();
+      for (DataIterator dit(level.dbl); dit.ok(); ++dit)
+        {
+          const Box box = level.dbl[dit];
+          FArrayBox& fab = a_data[dit];
+          const FArrayBox& crFab = crBuffer[(*dit).localIndex()];
+          Box remain = fab.box();
+          remain &= domain;
+          for (int dir = 0; dir != g_SpaceDim; ++dir)
+            {
+              if (remain.loVect(dir) < box.loVect(dir))
+                {
+                  Box slab(remain);
+                  slab.hiVect(dir) = box.loVect(dir) - 1;
+                  interpolateFab(crFab, level.refRatio, slab, fab);
+                }
+              if (remain.hiVect(dir) > box.hiVect(dir))
+                {
+                  Box slab(remain);
+                  slab.loVect(dir) = box.hiVect(dir) + 1;
+                  interpolateFab(crFab, level.refRatio, slab, fab);
+                }
+              remain.loVect(dir) = box.loVect(dir);
+              remain.hiVect(dir) = box.hiVect(dir);
+            }
+        }
+    }
+  a_data.exchange(level.copier);
+}
+
+/*--------------------------------------------------------------------*/
+//  Advance all levels by a time step of the coarsest level
+/** \param[in]  a_dt    Time step on level 0.  Level l steps with
+ *                      a_dt divided by the product of the ratios of
+ *                      levels 1 to l.
+ *  \param[in]  a_step  Function updating the new data on a level from
+ *                      the old data (with filled ghost cells)
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::advance(const Real a_dt, const StepFunction& a_step)
+{
+  CH_assert(numLevel() > 0);
+  advanceLevel(0, a_dt, a_step);
+}
+
+/*--------------------------------------------------------------------*/
+//  Conservative average of fine cells onto a coarse region
+/** \param[in]  a_fnFab Fine data covering the refined a_crBox
+ *  \param[in]  a_refRatio
+ *                      Refinement ratio
+ *  \param[in]  a_crBox Coarse region to average onto
+ *  \param[out] a_crFab Cells in a_crBox are the average of the fine
+ *                      cells they cover (all components)
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::averageFab(const FArrayBox& a_fnFab,
+                         const int        a_refRatio,
+                         const Box&       a_crBox,
+                         FArrayBox&       a_crFab)
+{
+  CH_assert(a_crFab.box().contains(a_crBox));
+  CH_assert(a_crFab.ncomp() <= a_fnFab.ncomp());
+  const Box fnCell(IntVect::Zero, (a_refRatio - 1)*IntVect::Unit);
+  const Real factor = 1./fnCell.size();
+  for (int icomp = 0, icomp_end = a_crFab.ncomp(); icomp != icomp_end;
+       ++icomp)
+    {
+      for (BoxIterator bit(a_crBox); bit.ok(); ++bit)
+        {
+          const IntVect ivFn = a_refRatio*(*bit);
+          Real sum = 0.;
+          for (BoxIterator cit(fnCell); cit.ok(); ++cit)
+            {
+              sum += a_fnFab(ivFn + *cit, icomp);
+            }
+          a_crFab(*bit, icomp) = factor*sum;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Piecewise linear interpolation of coarse cells onto a fine region
+/** Slopes are limited with minmod so no new extrema are created.  A
+ *  slope is zero in any direction where a neighbour of the coarse
+ *  cell is outside a_crFab.  The average of the fine cells in a coarse
+ *  cell is the coarse value (conservative).
+ *  \param[in]  a_crFab Coarse data covering the coarsened a_fnBox
+ *  \param[in]  a_refRatio
+ *                      Refinement ratio
+ *  \param[in]  a_fnBox Fine region to interpolate to
+ *  \param[out] a_fnFab Cells in a_fnBox are interpolated (all
+ *                      components)
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::interpolateFab(const FArrayBox& a_crFab,
+                             const int        a_refRatio,
+                             const Box&       a_fnBox,
+                             FArrayBox&       a_fnFab)
+{
+  CH_assert(a_fnFab.box().contains(a_fnBox));
+  CH_assert(a_fnFab.ncomp() <= a_crFab.ncomp());
+  const Box& crAvail = a_crFab.box();
+  for (BoxIterator bit(a_fnBox); bit.ok(); ++bit)
+    {
+      const IntVect& ivFn = *bit;
+      IntVect ivCr;
+      Real xi[g_SpaceDim];
+      for (int dir = 0; dir != g_SpaceDim; ++dir)
+        {
+          ivCr[dir] = (ivFn[dir] >= 0) ?
+            ivFn[dir]/a_refRatio :
+            -((-ivFn[dir] + a_refRatio - 1)/a_refRatio);
+          // Offset of the fine cell center in units of coarse cells
+          xi[dir] = (ivFn[dir] - ivCr[dir]*a_refRatio + 0.5)/a_refRatio - 0.5;
+        }
+      CH_assert(crAvail.contains(ivCr));
+      for (int icomp = 0, icomp_end = a_fnFab.ncomp(); icomp != icomp_end;
+           ++icomp)
+        {
+          const Real val = a_crFab(ivCr, icomp);
+          Real fnVal = val;
+          for (int dir = 0; dir != g_SpaceDim; ++dir)
+            {
+              IntVect ivLo(ivCr);
+              IntVect ivHi(ivCr);
+              --ivLo[dir];
+              ++ivHi[dir];
+              if (crAvail.contains(ivLo) && crAvail.contains(ivHi))
+                {
+                  const Real dLo = val - a_crFab(ivLo, icomp);
+                  const Real dHi = a_crFab(ivHi, icomp) - val;
+                  Real slope = 0.;
+                  if (dLo*dHi > 0.)
+                    {
+                      slope = (dLo > 0.) ? std::min(dLo, dHi) :
+                        std::max(dLo, dHi);
+                    }
+                  fnVal += slope*xi[dir];
+                }
+            }
+          a_fnFab(ivFn, icomp) = fnVal;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Advance a level and, recursively, the finer levels
+/** The new data becomes the old data, its ghost cells are filled, and
+ *  the step function computes the new data.  Finer levels then take
+ *  refRatio steps to catch up and are averaged onto this level.
+ *  \param[in]  a_lvl   Level
+ *  \param[in]  a_dt    Time step on this level
+ *  \param[in]  a_step  Function updating the new data on a level
+ *//*-----------------------------------------------------------------*/
+
+void
+AMRHierarchy::advanceLevel(const int           a_lvl,
+                           const Real          a_dt,
+                           const StepFunction& a_step)
+{
+  Level& level = *m_levels[a_lvl];
+  LevelData<FArrayBox>& data = *level.data;
+  LevelData<FArrayBox>& dataOld = *level.dataOld;
+  for (DataIterator dit(level.dbl); dit.ok(); ++dit)
+    {
+      dataOld[dit].copy(level.dbl[dit], data[dit]);
+    }
+  level.timeOld = level.time;
+  fillGhosts(a_lvl, dataOld, level.timeOld);
+  a_step(a_lvl, level.timeOld, a_dt);
+  level.time = level.timeOld + a_dt;
+
+  // Subcycle the finer level
+  if (a_lvl + 1 < numLevel())
+    {
+      Level& fnLevel = *m_levels[a_lvl + 1];
+      const int ratio = fnLevel.refRatio;
+      for (int i = 0; i != ratio; ++i)
+        {
+          advanceLevel(a_lvl + 1, a_dt/ratio, a_step);
+        }
+      // Avoid drift from round-off in the sum of fine steps
+      fnLevel.time = level.time;
+      averageDown(a_lvl + 1);
+    }
+}
@@ -13,14 +13,800 @@
 #include <iomanip>
 #endif
 
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
 #include "BaseFab.H"
 #include "BaseFabMacros.H"
+#include "LinuxSupport.H"
+
+#ifdef DEBUGFAB
+  #define FABDBG(x) x
+#else
+  #define FABDBG(x) (void)0
+#endif
+
+
+/*******************************************************************************
+ *
+ * Copies between regions of BaseFabs and buffers
+ *
+ ******************************************************************************/
+
+namespace
+{
+
+/// Regions with shorter contiguous runs are copied by a cell loop
+constexpr size_t c_minRunBytes = 1024;
+
+/*--------------------------------------------------------------------*/
+//  Copy a contiguous run of elements
+/*--------------------------------------------------------------------*/
+
+template <typename T>
+inline void
+copyRun(T *__restrict__ a_dst, const T *__restrict__ a_src,
+        const std::ptrdiff_t a_num)
+{
+  std::memcpy(a_dst, a_src, a_num*sizeof(T));
+}
+
+/*--------------------------------------------------------------------*/
+//  Are all components in a range selected by the flags?
+/*--------------------------------------------------------------------*/
+
+inline bool
+allCompFlags(const int a_startComp, const int a_endComp,
+             const unsigned a_compFlags)
+{
+  for (int ic = a_startComp; ic != a_endComp; ++ic)
+    {
+      if ((ic < (int)(8*sizeof(unsigned))) && !(a_compFlags & (1 << ic)))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/*--------------------------------------------------------------------*/
+//  Contiguous runs of a region in arrays
+/** Pencils in x are contiguous.  Consecutive pencils (and then planes)
+ *  are merged into a single run while the region spans the whole
+ *  array in both arrays.
+ *  \param[in]  a_len   Dimensions of the region
+ *  \param[in]  a_dimsA Dimensions of the first array (in run units)
+ *  \param[in]  a_dimsB Dimensions of the second array (in run units)
+ *  \param[out] a_runBox
+ *                      Box with one cell per run (from IntVect::Zero,
+ *                      with length 1 in merged directions)
+ *  \return             Number of cells in a run
+ *//*-----------------------------------------------------------------*/
+
+inline std::ptrdiff_t
+findRuns(const IntVect& a_len, const IntVect& a_dimsA, const IntVect& a_dimsB,
+         Box& a_runBox)
+{
+  IntVect numRun(a_len);
+  std::ptrdiff_t run = a_len[0];
+  numRun[0] = 1;
+  for (int dir = 1; dir != g_SpaceDim; ++dir)
+    {
+      if (a_len[dir-1] != a_dimsA[dir-1] || a_len[dir-1] != a_dimsB[dir-1])
+        {
+          break;
+        }
+      run *= a_len[dir];
+      numRun[dir] = 1;
+    }
+  a_runBox = Box(IntVect::Zero, numRun - IntVect::Unit);
+  return run;
+}
+
+/*--------------------------------------------------------------------*/
+//  Offset of a run from the start of an array
+/** The x-index of the run is always 0.  Computed in 64 bits since
+ *  the offset in a large array may exceed 2^31.
+ *  \param[in]  a_stride
+ *                      Strides of the array
+ *  \param[in]  a_j1, a_j2
+ *                      Index of the run in directions y and z (see
+ *                      findRuns)
+ *//*-----------------------------------------------------------------*/
+
+inline std::ptrdiff_t
+runOffset(const IntVect& a_stride, D_DECL(int, const int a_j1, const int a_j2))
+{
+  return D_TERM(0,
+                + (std::ptrdiff_t)a_j1*a_stride[1],
+                + (std::ptrdiff_t)a_j2*a_stride[2]);
+}
+
+/*--------------------------------------------------------------------*/
+//  Copy a region, cell by cell, between BaseFabs with any layouts
+/** Components are in the inner loop so interleaved data is read and
+ *  written a cell at a time.  See BaseFab::copy for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename DstLayout, typename SrcLayout>
+void
+copyCells(BaseFab<T, DstLayout>&       a_dst,
+          const Box&                   a_dstBox,
+          const int                    a_dstComp,
+          const BaseFab<T, SrcLayout>& a_src,
+          const Box&                   a_srcBox,
+          const int                    a_srcComp,
+          const int                    a_numComp,
+          const unsigned               a_compFlags)
+{
+  MD_LAYOUT_ARRAY(arrSrc, a_src);
+  MD_LAYOUT_ARRAY(arrDst, a_dst);
+  IntVect offset = a_srcBox.loVect() - a_dstBox.loVect();
+  MD_BOXLOOP(a_dstBox, i)
+    {
+      for (int ic = 0; ic != a_numComp; ++ic)
+        {
+          const int iDstC = ic + a_dstComp;
+          if ((iDstC >= (int)(8*sizeof(unsigned))) ||
+              (a_compFlags & (1 << iDstC)))
+            {
+              arrDst[MD_IX(i, iDstC)] =
+                arrSrc[MD_OFFSETIV(i,+,offset, ic + a_srcComp)];
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Copy a region between BaseFabs with LayoutSoA
+/** Long contiguous runs (consecutive pencils or planes spanning both
+ *  arrays) are copied by std::memcpy.  If the runs are whole components
+ *  and all components are selected, everything is copied as a single
+ *  run.  Short runs (e.g., the pencils of a ghost region) are copied by
+ *  a cell loop the compiler vectorizes.  See BaseFab::copy for
+ *  parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T>
+void
+copyRegion(BaseFab<T, LayoutSoA>&       a_dst,
+           const Box&                   a_dstBox,
+           const int                    a_dstComp,
+           const BaseFab<T, LayoutSoA>& a_src,
+           const Box&                   a_srcBox,
+           const int                    a_srcComp,
+           const int                    a_numComp,
+           const unsigned               a_compFlags)
+{
+  if (a_dstBox.isEmpty())
+    {
+      return;
+    }
+  Box runBox;
+  const std::ptrdiff_t run = findRuns(a_dstBox.dimensions(),
+                                      a_dst.getArrayDims(),
+                                      a_src.getArrayDims(), runBox);
+  T* dstBase = &a_dst(a_dstBox.loVect(), a_dstComp);
+  const T* srcBase = &a_src(a_srcBox.loVect(), a_srcComp);
+  const std::ptrdiff_t dstCompStride = a_dst.getComponentStride();
+  const std::ptrdiff_t srcCompStride = a_src.getComponentStride();
+  if (run == dstCompStride && run == srcCompStride &&
+      allCompFlags(a_dstComp, a_dstComp + a_numComp, a_compFlags))
+    {
+      copyRun(dstBase, srcBase, a_numComp*run);
+      return;
+    }
+  if (run*sizeof(T) < c_minRunBytes)
+    {
+      MD_ARRAY_RESTRICT(arrSrc, a_src);
+      MD_ARRAY_RESTRICT(arrDst, a_dst);
+      IntVect offset = a_srcBox.loVect() - a_dstBox.loVect();
+      for (int ic = 0; ic != a_numComp; ++ic)
+        {
+          const int iDstC = ic + a_dstComp;
+          if ((iDstC >= (int)(8*sizeof(unsigned))) ||
+              (a_compFlags & (1 << iDstC)))
+            {
+              const int iSrcC = ic + a_srcComp;
+              MD_BOXLOOP(a_dstBox, i)
+                {
+                  arrDst[MD_IX(i, iDstC)] =
+                    arrSrc[MD_OFFSETIV(i,+,offset, iSrcC)];
+                }
+            }
+        }
+      return;
+    }
+  const IntVect& dstStride = a_dst.getStride();
+  const IntVect& srcStride = a_src.getStride();
+  for (int ic = 0; ic != a_numComp; ++ic)
+    {
+      const int iDstC = ic + a_dstComp;
+      if ((iDstC >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << iDstC)))
+        {
+          T* dstC = dstBase + ic*dstCompStride;
+          const T* srcC = srcBase + ic*srcCompStride;
+          MD_BOXLOOP(runBox, j)
+            {
+              copyRun(dstC + runOffset(dstStride, MD_EXPANDIX(j)),
+                      srcC + runOffset(srcStride, MD_EXPANDIX(j)),
+                      run);
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Copy a region between BaseFabs with the same interleaved layout
+/** If all components are copied and the region covers whole blocks in
+ *  x, each pencil of blocks (and consecutive pencils spanning the whole
+ *  array) is contiguous and copied as a run.  Otherwise, the region is
+ *  copied cell by cell.  See BaseFab::copy for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+copyRegion(BaseFab<T, Layout>&       a_dst,
+           const Box&                a_dstBox,
+           const int                 a_dstComp,
+           const BaseFab<T, Layout>& a_src,
+           const Box&                a_srcBox,
+           const int                 a_srcComp,
+           const int                 a_numComp,
+           const unsigned            a_compFlags)
+{
+  constexpr int width = Layout::c_width;
+  const IntVect len = a_dstBox.dimensions();
+  const int ncomp = a_dst.ncomp();
+  if (a_dstComp != 0 || a_srcComp != 0 || a_numComp != ncomp ||
+      a_src.ncomp() != ncomp || len[0] % width != 0 ||
+      (a_dstBox.loVect()[0] - a_dst.box().loVect()[0]) % width != 0 ||
+      (a_srcBox.loVect()[0] - a_src.box().loVect()[0]) % width != 0 ||
+      !allCompFlags(0, ncomp, a_compFlags) || a_dstBox.isEmpty())
+    {
+      copyCells(a_dst, a_dstBox, a_dstComp, a_src, a_srcBox, a_srcComp,
+                a_numComp, a_compFlags);
+      return;
+    }
+  Box runBox;
+  const std::ptrdiff_t run = ncomp*findRuns(len, a_dst.getArrayDims(),
+                                            a_src.getArrayDims(), runBox);
+  T* dstBase = &a_dst(a_dstBox.loVect(), 0);
+  const T* srcBase = &a_src(a_srcBox.loVect(), 0);
+  const IntVect& dstStride = a_dst.getStride();
+  const IntVect& srcStride = a_src.getStride();
+  MD_BOXLOOP(runBox, j)
+    {
+      copyRun(dstBase + runOffset(dstStride, MD_EXPANDIX(j)),
+              srcBase + runOffset(srcStride, MD_EXPANDIX(j)),
+              run);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Copy a region between BaseFabs with different layouts
+/** See BaseFab::copy for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename DstLayout, typename SrcLayout>
+void
+copyRegion(BaseFab<T, DstLayout>&       a_dst,
+           const Box&                   a_dstBox,
+           const int                    a_dstComp,
+           const BaseFab<T, SrcLayout>& a_src,
+           const Box&                   a_srcBox,
+           const int                    a_srcComp,
+           const int                    a_numComp,
+           const unsigned               a_compFlags)
+{
+  copyCells(a_dst, a_dstBox, a_dstComp, a_src, a_srcBox, a_srcComp,
+            a_numComp, a_compFlags);
+}
+
+/*--------------------------------------------------------------------*/
+//  Linearize a region of a BaseFab with LayoutSoA
+/** Long contiguous runs are copied as in copyRegion.  See
+ *  BaseFab::linearOut for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T>
+void
+linearOutRegion(const BaseFab<T, LayoutSoA>& a_fab,
+                T*                           a_buffer,
+                const Box&                   a_region,
+                const int                    a_startComp,
+                const int                    a_endComp,
+                const unsigned               a_compFlags)
+{
+  if (a_region.isEmpty())
+    {
+      return;
+    }
+  const IntVect dims = a_fab.getArrayDims();
+  Box runBox;
+  const std::ptrdiff_t run =
+    findRuns(a_region.dimensions(), dims, dims, runBox);
+  const std::ptrdiff_t compStride = a_fab.getComponentStride();
+  const T* base = &a_fab(a_region.loVect(), 0);
+  if (run == compStride &&
+      allCompFlags(a_startComp, a_endComp, a_compFlags))
+    {
+      copyRun(a_buffer, base + a_startComp*compStride,
+              (a_endComp - a_startComp)*run);
+      return;
+    }
+  if (run*sizeof(T) < c_minRunBytes)
+    {
+      MD_ARRAY_RESTRICT(arr, a_fab);
+      for (int ic = a_startComp; ic != a_endComp; ++ic)
+        {
+          if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+            {
+              MD_BOXLOOP(a_region, i)
+                {
+                  *a_buffer++ = arr[MD_IX(i, ic)];
+                }
+            }
+        }
+      return;
+    }
+  const IntVect& stride = a_fab.getStride();
+  for (int ic = a_startComp; ic != a_endComp; ++ic)
+    {
+      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+        {
+          const T* p = base + ic*compStride;
+          MD_BOXLOOP(runBox, j)
+            {
+              copyRun(a_buffer,
+                      p + runOffset(stride, MD_EXPANDIX(j)),
+                      run);
+              a_buffer += run;
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Linearize a region of a BaseFab with any layout
+/** The buffer has the same order (component slowest) for all layouts.
+ *  See BaseFab::linearOut for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+linearOutRegion(const BaseFab<T, Layout>& a_fab,
+                T*                        a_buffer,
+                const Box&                a_region,
+                const int                 a_startComp,
+                const int                 a_endComp,
+                const unsigned            a_compFlags)
+{
+  MD_LAYOUT_ARRAY(arr, a_fab);
+  for (int ic = a_startComp; ic != a_endComp; ++ic)
+    {
+      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+        {
+          MD_BOXLOOP(a_region, i)
+            {
+              *a_buffer++ = arr[MD_IX(i, ic)];
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Replace a region of a BaseFab with LayoutSoA from a buffer
+/** Long contiguous runs are copied as in copyRegion.  See
+ *  BaseFab::linearIn for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T>
+void
+linearInRegion(BaseFab<T, LayoutSoA>& a_fab,
+               const T*               a_buffer,
+               const Box&             a_region,
+               const int              a_startComp,
+               const int              a_endComp,
+               const unsigned         a_compFlags)
+{
+  if (a_region.isEmpty())
+    {
+      return;
+    }
+  const IntVect dims = a_fab.getArrayDims();
+  Box runBox;
+  const std::ptrdiff_t run =
+    findRuns(a_region.dimensions(), dims, dims, runBox);
+  const std::ptrdiff_t compStride = a_fab.getComponentStride();
+  T* base = &a_fab(a_region.loVect(), 0);
+  if (run == compStride &&
+      allCompFlags(a_startComp, a_endComp, a_compFlags))
+    {
+      copyRun(base + a_startComp*compStride, a_buffer,
+              (a_endComp - a_startComp)*run);
+      return;
+    }
+  if (run*sizeof(T) < c_minRunBytes)
+    {
+      MD_ARRAY_RESTRICT(arr, a_fab);
+      for (int ic = a_startComp; ic != a_endComp; ++ic)
+        {
+          if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+            {
+              MD_BOXLOOP(a_region, i)
+                {
+                  arr[MD_IX(i, ic)] = *a_buffer++;
+                }
+            }
+        }
+      return;
+    }
+  const IntVect& stride = a_fab.getStride();
+  for (int ic = a_startComp; ic != a_endComp; ++ic)
+    {
+      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+        {
+          T* p = base + ic*compStride;
+          MD_BOXLOOP(runBox, j)
+            {
+              copyRun(p + runOffset(stride, MD_EXPANDIX(j)),
+                      a_buffer,
+                      run);
+              a_buffer += run;
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Replace a region of a BaseFab with any layout from a buffer
+/** See BaseFab::linearIn for parameters.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+linearInRegion(BaseFab<T, Layout>& a_fab,
+               const T*            a_buffer,
+               const Box&          a_region,
+               const int           a_startComp,
+               const int           a_endComp,
+               const unsigned      a_compFlags)
+{
+  MD_LAYOUT_ARRAY(arr, a_fab);
+  for (int ic = a_startComp; ic != a_endComp; ++ic)
+    {
+      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
+        {
+          MD_BOXLOOP(a_region, i)
+            {
+              arr[MD_IX(i, ic)] = *a_buffer++;
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Assign a constant to a component in a region of a BaseFab with
+//  LayoutSoA
+/** Long contiguous runs (whole planes or the whole component) are
+ *  filled as runs.  Otherwise, the region is filled cell by cell.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T>
+void
+setRegion(BaseFab<T, LayoutSoA>& a_fab,
+          const Box&             a_region,
+          const int              a_icomp,
+          const T&               a_val)
+{
+  if (a_region.isEmpty())
+    {
+      return;
+    }
+  const IntVect dims = a_fab.getArrayDims();
+  Box runBox;
+  const std::ptrdiff_t run =
+    findRuns(a_region.dimensions(), dims, dims, runBox);
+  if (run*sizeof(T) < c_minRunBytes)
+    {
+      MD_ARRAY_RESTRICT(arr, a_fab);
+      MD_BOXLOOP(a_region, i)
+        {
+          arr[MD_IX(i, a_icomp)] = a_val;
+        }
+      return;
+    }
+  T* p = &a_fab(a_region.loVect(), a_icomp);
+  const IntVect& stride = a_fab.getStride();
+  MD_BOXLOOP(runBox, j)
+    {
+      std::fill_n(p + runOffset(stride, MD_EXPANDIX(j)), run, a_val);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Assign a constant to a component in a region of a BaseFab with any
+//  layout
+/*--------------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+setRegion(BaseFab<T, Layout>& a_fab,
+          const Box&          a_region,
+          const int           a_icomp,
+          const T&            a_val)
+{
+  MD_LAYOUT_ARRAY(arr, a_fab);
+  MD_BOXLOOP(a_region, i)
+    {
+      arr[MD_IX(i, a_icomp)] = a_val;
+    }
+}
+
+/// Arithmetic on regions with fewer elements is not threaded
+constexpr int c_ompMinElem = 32768;
+
+/*--------------------------------------------------------------------*/
+//  Absolute value (also for unsigned and bool)
+/*--------------------------------------------------------------------*/
+
+template <typename T>
+inline T
+absVal(const T a_x)
+{
+  return (a_x < T(0)) ? T(-a_x) : a_x;
+}
+
+/*--------------------------------------------------------------------*/
+//  Product (logical and for bool)
+/*--------------------------------------------------------------------*/
+
+template <typename T>
+inline T
+product(const T a_x, const T a_y)
+{
+  return a_x*a_y;
+}
+
+inline bool
+product(const bool a_x, const bool a_y)
+{
+  return a_x && a_y;
+}
+
+/*--------------------------------------------------------------------*/
+//  Start of a pencil in x of a BaseFab
+/** \param[in]  a_fab   BaseFab
+ *  \param[in]  a_box   Region
+ *  \param[in]  a_idx   Index of the pencil in a_box (x-pencils of
+ *                      a_box are numbered from 0 with y fastest)
+ *  \param[in]  a_icomp Component
+ *  \return             Location of the cell of a_fab in the pencil
+ *                      with x at the lower corner of a_fab
+ *//*-----------------------------------------------------------------*/
+
+template <typename FAB>
+inline auto
+pencilPtr(FAB& a_fab, const Box& a_box, int a_idx, const int a_icomp)
+{
+  IntVect iv(a_box.loVect());
+  iv[0] = a_fab.box().loVect()[0];
+  for (int dir = 1; dir != g_SpaceDim; ++dir)
+    {
+      const int len = a_box.dimensions()[dir];
+      iv[dir] += a_idx % len;
+      a_idx /= len;
+    }
+  return &a_fab(iv, a_icomp);
+}
+
+/*--------------------------------------------------------------------*/
+//  Offset of a cell along a pencil in x
+/** For LayoutSoA, this is just a_r, so the loops below are
+ *  unit-stride and vectorize.
+ *  \param[in]  a_r     Cell in x relative to the lower corner of the
+ *                      BaseFab
+ *  \param[in]  a_stride0
+ *                      x-stride of the BaseFab
+ *//*-----------------------------------------------------------------*/
+
+template <typename Layout>
+inline int
+pencilOffset(const int a_r, const int a_stride0)
+{
+  constexpr int width = Layout::c_width;
+  return (Layout::c_interleaved) ? (a_r/width)*a_stride0 + a_r%width : a_r;
+}
+
+/*--------------------------------------------------------------------*/
+//  Apply an operation to each element in a region of up to 3 BaseFabs
+/** The pencils are distributed among the threads and each pencil is a
+ *  SIMD loop.  The operation is called as a_op(dst, x, y), with x and
+ *  y widened to the compute type, and must only modify dst.  Unused
+ *  BaseFabs can be the destination.
+ *  \param[in]  a_box   Region (in all BaseFabs)
+ *  \param[in]  a_numComp
+ *                      Number of components
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout, typename Op>
+void
+mapRegion(BaseFab<T, Layout>&       a_dst,
+          const int                 a_dstComp,
+          const BaseFab<T, Layout>& a_x,
+          const int                 a_xComp,
+          const BaseFab<T, Layout>& a_y,
+          const int                 a_yComp,
+          const Box&                a_box,
+          const int                 a_numComp,
+          const Op&                 a_op)
+{
+  using C = typename BaseFab<T, Layout>::compute_type;
+  if (a_box.isEmpty())
+    {
+      return;
+    }
+  const int len0 = a_box.dimensions()[0];
+  const int numPencil = a_box.size()/len0;
+  const int rDst = a_box.loVect()[0] - a_dst.box().loVect()[0];
+  const int rX   = a_box.loVect()[0] - a_x.box().loVect()[0];
+  const int rY   = a_box.loVect()[0] - a_y.box().loVect()[0];
+  const int sDst = a_dst.getStride()[0];
+  const int sX   = a_x.getStride()[0];
+  const int sY   = a_y.getStride()[0];
+#pragma omp parallel for default(shared) collapse(2) \
+  if (a_numComp*a_box.size() >= c_ompMinElem)
+  for (int ic = 0; ic < a_numComp; ++ic)
+    {
+      for (int idx = 0; idx < numPencil; ++idx)
+        {
+          T* dst = pencilPtr(a_dst, a_box, idx, a_dstComp + ic);
+          const T* x = pencilPtr(a_x, a_box, idx, a_xComp + ic);
+          const T* y = pencilPtr(a_y, a_box, idx, a_yComp + ic);
+#pragma omp simd
+          for (int i = 0; i < len0; ++i)
+            {
+              a_op(dst[pencilOffset<Layout>(rDst + i, sDst)],
+                   C(x[pencilOffset<Layout>(rX + i, sX)]),
+                   C(y[pencilOffset<Layout>(rY + i, sY)]));
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Sum of a function of the elements in a region
+/** Elements are widened to the compute type before a_f is applied and
+ *  the sum is accumulated in the compute type.
+ *  \param[in]  a_f     Function applied to each element
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout, typename F>
+typename BaseFab<T, Layout>::compute_type
+sumRegion(const BaseFab<T, Layout>& a_fab,
+          const Box&                a_box,
+          const int                 a_startComp,
+          const int                 a_endComp,
+          const F&                  a_f)
+{
+  using C = typename BaseFab<T, Layout>::compute_type;
+  C total = C(0);
+  if (a_box.isEmpty())
+    {
+      return total;
+    }
+  const int len0 = a_box.dimensions()[0];
+  const int numPencil = a_box.size()/len0;
+  const int r0 = a_box.loVect()[0] - a_fab.box().loVect()[0];
+  const int s0 = a_fab.getStride()[0];
+#pragma omp parallel for default(shared) collapse(2) reduction(+:total) \
+  if ((a_endComp - a_startComp)*a_box.size() >= c_ompMinElem)
+  for (int ic = a_startComp; ic < a_endComp; ++ic)
+    {
+      for (int idx = 0; idx < numPencil; ++idx)
+        {
+          const T* p = pencilPtr(a_fab, a_box, idx, ic);
+          C pencilTotal = C(0);
+#pragma omp simd reduction(+:pencilTotal)
+          for (int i = 0; i < len0; ++i)
+            {
+              pencilTotal += a_f(C(p[pencilOffset<Layout>(r0 + i, s0)]));
+            }
+          total += pencilTotal;
+        }
+    }
+  return total;
+}
+
+/*--------------------------------------------------------------------*/
+//  Maximum of a function of the elements in a region
+/** \param[in]  a_f     Function applied to each element (widened to
+ *                      the compute type)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout, typename F>
+typename BaseFab<T, Layout>::compute_type
+maxRegion(const BaseFab<T, Layout>& a_fab,
+          const Box&                a_box,
+          const int                 a_startComp,
+          const int                 a_endComp,
+          const F&                  a_f)
+{
+  using C = typename BaseFab<T, Layout>::compute_type;
+  C result = std::numeric_limits<C>::lowest();
+  if (a_box.isEmpty())
+    {
+      return result;
+    }
+  const int len0 = a_box.dimensions()[0];
+  const int numPencil = a_box.size()/len0;
+  const int r0 = a_box.loVect()[0] - a_fab.box().loVect()[0];
+  const int s0 = a_fab.getStride()[0];
+#pragma omp parallel for default(shared) collapse(2) reduction(max:result) \
+  if ((a_endComp - a_startComp)*a_box.size() >= c_ompMinElem)
+  for (int ic = a_startComp; ic < a_endComp; ++ic)
+    {
+      for (int idx = 0; idx < numPencil; ++idx)
+        {
+          const T* p = pencilPtr(a_fab, a_box, idx, ic);
+          C pencilMax = std::numeric_limits<C>::lowest();
+#pragma omp simd reduction(max:pencilMax)
+          for (int i = 0; i < len0; ++i)
+            {
+              const C val = a_f(C(p[pencilOffset<Layout>(r0 + i, s0)]));
+              pencilMax = (val > pencilMax) ? val : pencilMax;
+            }
+          result = (pencilMax > result) ? pencilMax : result;
+        }
+    }
+  return result;
+}
+
+/*--------------------------------------------------------------------*/
+//  Minimum of the elements in a region
+/*--------------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+typename BaseFab<T, Layout>::compute_type
+minRegion(const BaseFab<T, Layout>& a_fab,
+          const Box&                a_box,
+          const int                 a_startComp,
+          const int                 a_endComp)
+{
+  using C = typename BaseFab<T, Layout>::compute_type;
+  C result = std::numeric_limits<C>::max();
+  if (a_box.isEmpty())
+    {
+      return result;
+    }
+  const int len0 = a_box.dimensions()[0];
+  const int numPencil = a_box.size()/len0;
+  const int r0 = a_box.loVect()[0] - a_fab.box().loVect()[0];
+  const int s0 = a_fab.getStride()[0];
+#pragma omp parallel for default(shared) collapse(2) reduction(min:result) \
+  if ((a_endComp - a_startComp)*a_box.size() >= c_ompMinElem)
+  for (int ic = a_startComp; ic < a_endComp; ++ic)
+    {
+      for (int idx = 0; idx < numPencil; ++idx)
+        {
+          const T* p = pencilPtr(a_fab, a_box, idx, ic);
+          C pencilMin = std::numeric_limits<C>::max();
+#pragma omp simd reduction(min:pencilMin)
+          for (int i = 0; i < len0; ++i)
+            {
+              const C val = p[pencilOffset<Layout>(r0 + i, s0)];
+              pencilMin = (val < pencilMin) ? val : pencilMin;
+            }
+          result = (pencilMin < result) ? pencilMin : result;
+        }
+    }
+  return result;
+}
 
-#ifdef DEBUGFAB
-  #define FABDBG(x) x
-#else
-  #define FABDBG(x) (void)0
-#endif
+}  // anonymous namespace
 
 
 /*******************************************************************************
@@ -29,12 +815,18 @@
  *
  ******************************************************************************/
 
+template <typename T, typename Layout>
+constexpr size_t BaseFab<T, Layout>::s_alignment;
+
+template <typename T, typename Layout>
+bool BaseFab<T, Layout>::s_padStride = false;
+
 /*--------------------------------------------------------------------*/
 //  Default constructor (no allocation)
 /*--------------------------------------------------------------------*/
 
-template <typename T>
-BaseFab<T>::BaseFab()
+template <typename T, typename Layout>
+BaseFab<T, Layout>::BaseFab()
   :
   m_box(),
   m_stride(IntVect::Zero),
@@ -56,7 +848,7 @@ BaseFab<T>::BaseFab()
  *                      is nullptr
  *//*-----------------------------------------------------------------*/
 /* template <typename T>
-BaseFab<T>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
+BaseFab<T, Layout>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
   :
   m_box(a_box),
   m_stride(IntVect::Zero),
@@ -68,8 +860,8 @@ BaseFab<T>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
   allocate();
   } */
 
-template <typename T>
-BaseFab<T>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
+template <typename T, typename Layout>
+BaseFab<T, Layout>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
   :
   m_box(a_box),
   m_ncomp(a_ncomp),
@@ -90,11 +882,11 @@ BaseFab<T>::BaseFab(const Box& a_box, const int a_ncomp, T *const a_alias)
  *                      is aliased to this address.  Default parameter
  *                      is nullptr
  *//*-----------------------------------------------------------------*/
-template <typename T>
-BaseFab<T>::BaseFab(const Box& a_box,
-                    const int  a_ncomp,
-                    const T&   a_val,
-                    T *const   a_alias)
+template <typename T, typename Layout>
+BaseFab<T, Layout>::BaseFab(const Box& a_box,
+                            const int  a_ncomp,
+                            const T&   a_val,
+                            T *const   a_alias)
   :
   m_box(a_box),
   m_stride(IntVect::Zero),
@@ -106,14 +898,32 @@ BaseFab<T>::BaseFab(const Box& a_box,
   allocate();
   setVal(a_val);
 }
+
+/*--------------------------------------------------------------------*/
+//  Constructor as a view of a region and components of another
+//  BaseFab
+/** See defineView for parameters.  No memory is allocated or copied.
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+BaseFab<T, Layout>::BaseFab(BaseFab&   a_fab,
+                            const Box& a_box,
+                            const int  a_startComp,
+                            const int  a_numComp)
+  :
+  m_data(nullptr),
+  m_allocBy(AllocBy::none)
+{
+  defineView(a_fab, a_box, a_startComp, a_numComp);
+}
 /*--------------------------------------------------------------------*/
 //  Move constructor
 /** Moving BaseFabs built as an alias will cause an error
  *  \param[in]  a_fab   Rvalue RHS
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
-BaseFab<T>::BaseFab(BaseFab&& a_fab) noexcept
+template <typename T, typename Layout>
+BaseFab<T, Layout>::BaseFab(BaseFab&& a_fab) noexcept
   :
   m_box(std::move(a_fab.m_box)),
   m_stride(std::move(a_fab.m_stride)),
@@ -141,9 +951,9 @@ BaseFab<T>::BaseFab(BaseFab&& a_fab) noexcept
 /** Moving BaseFabs built as an alias will cause an error
  * \param[in]  a_fab    Rvalue RHS
  *//*-----------------------------------------------------------------*/
-template <typename T>
-BaseFab<T>&
-BaseFab<T>::operator=(BaseFab&& a_fab) noexcept
+template <typename T, typename Layout>
+BaseFab<T, Layout>&
+BaseFab<T, Layout>::operator=(BaseFab&& a_fab) noexcept
 {
   FABDBG(std::cout << "BaseFab (" << std::setw(14) << m_data
          << "): move assignment construction\n");
@@ -172,9 +982,9 @@ BaseFab<T>::operator=(BaseFab&& a_fab) noexcept
  *                      is nullptr
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::define(const Box& a_box, const int a_ncomp, T *const a_alias)
+BaseFab<T, Layout>::define(const Box& a_box, const int a_ncomp, T *const a_alias)
 {
   FABDBG(std::cout << "BaseFab (" << std::setw(14) << m_data
          << "): define\n");
@@ -196,12 +1006,12 @@ BaseFab<T>::define(const Box& a_box, const int a_ncomp, T *const a_alias)
  *                      is nullptr
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::define(const Box& a_box,
-                   const int  a_ncomp,
-                   const T&   a_val,
-                   T *const   a_alias)
+BaseFab<T, Layout>::define(const Box& a_box,
+                           const int  a_ncomp,
+                           const T&   a_val,
+                           T *const   a_alias)
 {
   FABDBG(std::cout << "BaseFab (" << std::setw(14) << m_data
          << "): define\n");
@@ -214,12 +1024,96 @@ BaseFab<T>::define(const Box& a_box,
   setVal(a_val);
 }
 
+/*--------------------------------------------------------------------*/
+//  Weak construction as a view of a region of another BaseFab
+/** The view shares memory and strides with a_fab and has the same
+ *  number of components.  Since the data of the view is not
+ *  contiguous, it must not be sent as a single buffer.  Kernels
+ *  written with MD_ARRAY work on views without modification.
+ *  \param[in]  a_fab   BaseFab to view.  It must outlive the view.
+ *  \param[in]  a_box   Region of a_fab to view
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::defineView(BaseFab& a_fab, const Box& a_box)
+{
+  defineView(a_fab, a_box, 0, a_fab.m_ncomp);
+}
+
+/*--------------------------------------------------------------------*/
+//  Weak construction as a view of a region and components of another
+//  BaseFab
+/** The view carries the strides of a_fab and starts at the first
+ *  element of a_startComp in the region, so component 0 of the view is
+ *  component a_startComp of a_fab.  Use this to operate on a subset of
+ *  the components (e.g., only the density) without copying.
+ *  \param[in]  a_fab   BaseFab to view.  It must outlive the view.
+ *                      This may itself be a view.
+ *  \param[in]  a_box   Region of a_fab to view
+ *  \param[in]  a_startComp
+ *                      First component of a_fab in the view
+ *  \param[in]  a_numComp
+ *                      Number of components in the view
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::defineView(BaseFab&   a_fab,
+                               const Box& a_box,
+                               const int  a_startComp,
+                               const int  a_numComp)
+{
+  CH_assert(a_fab.box().contains(a_box));
+  CH_assert(a_startComp >= 0 && a_numComp >= 0 &&
+            a_startComp + a_numComp <= a_fab.m_ncomp);
+  // With LayoutAoSoA, the view must start on a block
+  CH_assert((a_box.loVect()[0] - a_fab.box().loVect()[0]) %
+            Layout::c_width == 0);
+  deallocate();
+  m_box = a_box;
+  m_stride = a_fab.m_stride;
+  m_ncomp = a_numComp;
+  m_size = a_fab.m_size;
+  m_data = &a_fab(a_box.loVect(), 0) + a_startComp*a_fab.m_size;
+  m_allocBy = AllocBy::view;
+}
+
+/*--------------------------------------------------------------------*/
+//  Pad strides of allocated BaseFabs so each pencil is aligned
+/** Only affects BaseFabs allocated after the call.  Aliased BaseFabs
+ *  are never padded.  Processes exchanging BaseFabs with
+ *  LevelData::migrate must use the same setting.
+ *  \param[in]  a_padStride
+ *                      T - round the x-stride up to a multiple of
+ *                          s_alignment bytes
+ *                      F - no padding (default)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::setPadStride(const bool a_padStride)
+{
+  s_padStride = a_padStride;
+}
+
+/*--------------------------------------------------------------------*/
+//  Are strides of allocated BaseFabs padded?
+/*--------------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+bool
+BaseFab<T, Layout>::padStride()
+{
+  return s_padStride;
+}
+
 /*--------------------------------------------------------------------*/
 //  Destructor
 /*--------------------------------------------------------------------*/
 
-template <typename T>
-BaseFab<T>::~BaseFab()
+template <typename T, typename Layout>
+BaseFab<T, Layout>::~BaseFab()
 {
   FABDBG(std::cout << "BaseFab (" << std::setw(14) << m_data
          << "): destructor\n");
@@ -231,12 +1125,21 @@ BaseFab<T>::~BaseFab()
 /** \param[in]  a_val   Value to assign
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::setVal(const T& a_val)
+BaseFab<T, Layout>::setVal(const T& a_val)
 {
+  if (m_allocBy == AllocBy::view)
+    {
+      for (int ic = 0; ic != m_ncomp; ++ic)
+        {
+          setVal(ic, a_val);
+        }
+      return;
+    }
+  // Padding, if any, is also set
   T* p = dataPtr(0);
-  for (int n = size(); n--;)
+  for (size_t n = storageSize(); n--;)
     {
       *p++ = a_val;
     }
@@ -248,40 +1151,86 @@ BaseFab<T>::setVal(const T& a_val)
  *  \param[in]  a_val   Value to assign
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::setVal(const int a_icomp, const T& a_val)
+BaseFab<T, Layout>::setVal(const int a_icomp, const T& a_val)
 {
   CH_assert(a_icomp >= 0 && a_icomp < m_ncomp);
+  if (m_allocBy == AllocBy::view || Layout::c_interleaved)
+    {
+      setRegion(*this, m_box, a_icomp, a_val);
+      return;
+    }
   T* p = dataPtr(a_icomp);
-  for (int n = m_box.size(); n--;)
+  for (std::ptrdiff_t n = m_size; n--;)
     {
       *p++ = a_val;
     }
 }
 
+/*--------------------------------------------------------------------*/
+//  Assign a constant to all components with the threads of MD_BOXLOOP_OMP
+/** Planes normal to the outermost direction are assigned by the same
+ *  OpenMP loop (bounds and default schedule) as MD_BOXLOOP_OMP(a_box,
+ *  i).  Planes of this BaseFab outside a_box (ghosts) go to the thread
+ *  with the nearest plane of a_box.  When this is the first touch of
+ *  the memory, each page is therefore placed on the NUMA node of the
+ *  thread that later computes on it.  Padding is also set.  With an
+ *  interleaved layout, all components of a plane are set at once.  A view is
+ *  set serially (its memory belongs to the viewed BaseFab).
+ *  \param[in]  a_val   Value to assign
+ *  \param[in]  a_box   Box of the loops computing on this BaseFab
+ *                      (usually m_box less ghosts)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::setValOMP(const T& a_val, const Box& a_box)
+{
+  constexpr int dirOuter = g_SpaceDim - 1;
+  CH_assert(a_box.loVect()[dirOuter] >= m_box.loVect()[dirOuter] &&
+            a_box.hiVect()[dirOuter] <= m_box.hiVect()[dirOuter]);
+  if (m_allocBy == AllocBy::view)
+    {
+      setVal(a_val);
+      return;
+    }
+  const int lo = m_box.loVect()[dirOuter];
+  const int hi = m_box.hiVect()[dirOuter];
+  const int partLo = a_box.loVect()[dirOuter];
+  const int partHi = a_box.hiVect()[dirOuter];
+  const std::ptrdiff_t planeSize = m_stride[dirOuter];
+  const int numPass = (Layout::c_interleaved) ? 1 : m_ncomp;
+#pragma omp parallel for default(shared)
+  for (int k = partLo; k <= partHi; ++k)
+    {
+      const int kBeg = (k == partLo) ? lo : k;
+      const int kEnd = (k == partHi) ? hi : k;
+      for (int ic = 0; ic != numPass; ++ic)
+        {
+          T* p = m_data + ic*m_size + (kBeg - lo)*planeSize;
+          for (std::ptrdiff_t n = (kEnd - kBeg + 1)*planeSize; n--;)
+            {
+              *p++ = a_val;
+            }
+        }
+    }
+}
+
 /*--------------------------------------------------------------------*/
 //  Copy a portion of another BaseFab, same region and all components
 /** \param[in]  a_box   Region to copy
  *  \param[in]  a_src   Source BaseFab
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::copy(const Box&     a_box,
-                 const BaseFab& a_src)
+BaseFab<T, Layout>::copy(const Box&     a_box,
+                         const BaseFab& a_src)
 {
   CH_assert(a_src.ncomp() == m_ncomp);
-  //**FIXME
-  MD_ARRAY_RESTRICT(arrSrc, a_src);
-  MD_ARRAY_RESTRICT(arrDst, *this);
-  for (int ic = 0; ic != a_src.ncomp(); ++ic)
-    {
-      MD_BOXLOOP(a_box, i)
-       {
-          arrDst[MD_IX(i, ic)] = arrSrc[MD_IX(i, ic)];
-       }
-    }
+  copyRegion(*this, a_box, 0, a_src, a_box, 0, m_ncomp,
+             std::numeric_limits<unsigned>::max());
 }
 
 /*--------------------------------------------------------------------*/
@@ -306,15 +1255,15 @@ BaseFab<T>::copy(const Box&     a_box,
  *                      used.
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::copy(const Box&     a_dstBox,
-                 const int      a_dstComp,
-                 const BaseFab& a_src,
-                 const Box&     a_srcBox,
-                 const int      a_srcComp,
-                 const int      a_numComp,
-                 const unsigned a_compFlags)
+BaseFab<T, Layout>::copy(const Box&     a_dstBox,
+                         const int      a_dstComp,
+                         const BaseFab& a_src,
+                         const Box&     a_srcBox,
+                         const int      a_srcComp,
+                         const int      a_numComp,
+                         const unsigned a_compFlags)
 {
   const IntVect len = a_dstBox.dimensions();
   // CH_assert(this != &a_src);
@@ -323,22 +1272,44 @@ BaseFab<T>::copy(const Box&     a_dstBox,
   CH_assert(a_src.box().contains(a_srcBox));
   CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
   CH_assert(a_srcComp >= 0 && (a_srcComp + a_numComp) <= a_src.ncomp());
+  copyRegion(*this, a_dstBox, a_dstComp, a_src, a_srcBox, a_srcComp,
+             a_numComp, a_compFlags);
+}
 
-  MD_ARRAY_RESTRICT(arrSrc, a_src);
-  MD_ARRAY_RESTRICT(arrDst, *this);
-  IntVect offset = a_srcBox.loVect() - a_dstBox.loVect();
-  for (int ic = 0; ic != a_numComp; ++ic)
-    {
-      const int iDstC = ic + a_dstComp;
-      if ((iDstC >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << iDstC)))
-        {
-          const int iSrcC = ic + a_srcComp;
-          MD_BOXLOOP(a_dstBox, i)
-            {
-              arrDst[MD_IX(i, iDstC)] = arrSrc[MD_OFFSETIV(i,+,offset, iSrcC)];
-            }
-        }
-    }
+/*--------------------------------------------------------------------*/
+//  Copy a portion of a BaseFab with a different layout
+/** Instantiated for Real between all layouts in the explicit
+ *  instantiations below.
+ *  \param[in]  a_dstBox
+ *                      Region to copy to in this BaseFab
+ *  \param[in]  a_dstComp
+ *                      Start index for destination components
+ *  \param[in]  a_src   Source BaseFab
+ *  \param[in]  a_srcBox
+ *                      Region to copy from in source BaseFab
+ *  \param[in]  a_srcComp
+ *                      Start index for source components
+ *  \param[in]  a_numComp
+ *                      Number of components to copy
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+template <typename SrcLayout>
+void
+BaseFab<T, Layout>::copy(const Box&                   a_dstBox,
+                         const int                    a_dstComp,
+                         const BaseFab<T, SrcLayout>& a_src,
+                         const Box&                   a_srcBox,
+                         const int                    a_srcComp,
+                         const int                    a_numComp)
+{
+  CH_assert(a_dstBox.dimensions() == a_srcBox.dimensions());
+  CH_assert(m_box.contains(a_dstBox));
+  CH_assert(a_src.box().contains(a_srcBox));
+  CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
+  CH_assert(a_srcComp >= 0 && (a_srcComp + a_numComp) <= a_src.ncomp());
+  copyRegion(*this, a_dstBox, a_dstComp, a_src, a_srcBox, a_srcComp,
+             a_numComp, std::numeric_limits<unsigned>::max());
 }
 
 /*--------------------------------------------------------------------*/
@@ -360,31 +1331,21 @@ BaseFab<T>::copy(const Box&     a_dstBox,
  *                      used.
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::linearOut(void *const    a_buffer,
-                      const Box&     a_region,
-                      const int      a_startComp,
-                      const int      a_endComp,
-                      const unsigned a_compFlags) const
+BaseFab<T, Layout>::linearOut(void *const    a_buffer,
+                              const Box&     a_region,
+                              const int      a_startComp,
+                              const int      a_endComp,
+                              const unsigned a_compFlags) const
 {
   CH_assert(a_buffer != NULL);
   CH_assert(m_box.contains(a_region));
   CH_assert(a_startComp >= 0);
   CH_assert(a_endComp >= a_startComp && a_endComp <= m_ncomp);
 
-  MD_ARRAY_RESTRICT(arr, *this);
-  T* p = static_cast<T*>(a_buffer);
-  for (int ic = a_startComp; ic != a_endComp; ++ic)
-    {
-      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
-        {
-          MD_BOXLOOP(a_region, i)
-            {
-              *p++ = arr[MD_IX(i, ic)];
-            }
-        }
-    }
+  linearOutRegion(*this, static_cast<T*>(a_buffer), a_region, a_startComp,
+                  a_endComp, a_compFlags);
 }
 
 /*--------------------------------------------------------------------*/
@@ -404,13 +1365,13 @@ BaseFab<T>::linearOut(void *const    a_buffer,
  *                      a_startComp.  Default, all components are
  *                      used.
  *//*-----------------------------------------------------------------*/
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::linearIn( const void* const a_buffer,
-                      const Box&     a_region,
-                      const int      a_startComp,
-                      const int      a_endComp,
-                      const unsigned a_compFlags)
+BaseFab<T, Layout>::linearIn( const void* const a_buffer,
+                              const Box&     a_region,
+                              const int      a_startComp,
+                              const int      a_endComp,
+                              const unsigned a_compFlags)
 {
   
   CH_assert(a_buffer != NULL);
@@ -418,29 +1379,330 @@ BaseFab<T>::linearIn( const void* const a_buffer,
   CH_assert(a_startComp >= 0);
   CH_assert(a_endComp >= a_startComp && a_endComp <= m_ncomp);
 
-  MD_ARRAY_RESTRICT(arr, *this);
-  const T* p = static_cast<const T*>(a_buffer);
-  for (int ic = a_startComp; ic != a_endComp; ++ic)
-    {
-      if ((ic >= (int)(8*sizeof(unsigned))) || (a_compFlags & (1 << ic)))
-        {
-          MD_BOXLOOP(a_region, i)
+  linearInRegion(*this, static_cast<const T*>(a_buffer), a_region,
+                 a_startComp, a_endComp, a_compFlags);
+}
+
+/*--------------------------------------------------------------------*/
+//  Add a constant to components in a region
+/** \param[in]  a_val   Value to add
+ *  \param[in]  a_box   Region
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::plus(const compute_type& a_val,
+                         const Box&          a_box,
+                         const int           a_startComp,
+                         const int           a_endComp)
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  mapRegion(*this, a_startComp, *this, a_startComp, *this, a_startComp,
+            a_box, a_endComp - a_startComp,
+            [a_val](T& a_d, const compute_type, const compute_type)
             {
-              arr[MD_IX(i, ic)] = *p++;
-            }
-        }
+              a_d = compute_type(a_d) + a_val;
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Add components of another BaseFab in a region
+/** \param[in]  a_box   Region (in both BaseFabs)
+ *  \param[in]  a_dstComp
+ *                      Start index for components of this BaseFab
+ *  \param[in]  a_src   BaseFab to add
+ *  \param[in]  a_srcComp
+ *                      Start index for components of a_src
+ *  \param[in]  a_numComp
+ *                      Number of components
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::plus(const Box&     a_box,
+                         const int      a_dstComp,
+                         const BaseFab& a_src,
+                         const int      a_srcComp,
+                         const int      a_numComp)
+{
+  CH_assert(m_box.contains(a_box) && a_src.box().contains(a_box));
+  CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
+  CH_assert(a_srcComp >= 0 && (a_srcComp + a_numComp) <= a_src.ncomp());
+  mapRegion(*this, a_dstComp, a_src, a_srcComp, a_src, a_srcComp,
+            a_box, a_numComp,
+            [](T& a_d, const compute_type a_x, const compute_type)
+            {
+              a_d = compute_type(a_d) + a_x;
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Multiply components in a region by a constant
+/** \param[in]  a_val   Multiplier
+ *  \param[in]  a_box   Region
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::mult(const compute_type& a_val,
+                         const Box&          a_box,
+                         const int           a_startComp,
+                         const int           a_endComp)
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  mapRegion(*this, a_startComp, *this, a_startComp, *this, a_startComp,
+            a_box, a_endComp - a_startComp,
+            [a_val](T& a_d, const compute_type, const compute_type)
+            {
+              a_d = product(compute_type(a_d), a_val);
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Multiply by components of another BaseFab in a region
+/** \param[in]  a_box   Region (in both BaseFabs)
+ *  \param[in]  a_dstComp
+ *                      Start index for components of this BaseFab
+ *  \param[in]  a_src   BaseFab to multiply by
+ *  \param[in]  a_srcComp
+ *                      Start index for components of a_src
+ *  \param[in]  a_numComp
+ *                      Number of components
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::mult(const Box&     a_box,
+                         const int      a_dstComp,
+                         const BaseFab& a_src,
+                         const int      a_srcComp,
+                         const int      a_numComp)
+{
+  CH_assert(m_box.contains(a_box) && a_src.box().contains(a_box));
+  CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
+  CH_assert(a_srcComp >= 0 && (a_srcComp + a_numComp) <= a_src.ncomp());
+  mapRegion(*this, a_dstComp, a_src, a_srcComp, a_src, a_srcComp,
+            a_box, a_numComp,
+            [](T& a_d, const compute_type a_x, const compute_type)
+            {
+              a_d = product(compute_type(a_d), a_x);
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Add a multiple of another BaseFab in a region (this += a*x)
+/** \param[in]  a_box   Region (in both BaseFabs)
+ *  \param[in]  a_dstComp
+ *                      Start index for components of this BaseFab
+ *  \param[in]  a_a     Multiplier of a_x
+ *  \param[in]  a_x     BaseFab to add
+ *  \param[in]  a_xComp Start index for components of a_x
+ *  \param[in]  a_numComp
+ *                      Number of components
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::axpy(const Box&          a_box,
+                         const int           a_dstComp,
+                         const compute_type& a_a,
+                         const BaseFab&      a_x,
+                         const int           a_xComp,
+                         const int           a_numComp)
+{
+  CH_assert(m_box.contains(a_box) && a_x.box().contains(a_box));
+  CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
+  CH_assert(a_xComp >= 0 && (a_xComp + a_numComp) <= a_x.ncomp());
+  mapRegion(*this, a_dstComp, a_x, a_xComp, a_x, a_xComp,
+            a_box, a_numComp,
+            [a_a](T& a_d, const compute_type a_xVal, const compute_type)
+            {
+              a_d = compute_type(a_d) + product(a_a, a_xVal);
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Linear combination of two BaseFabs in a region (this = a*x + b*y)
+/** Either a_x or a_y may be this BaseFab.
+ *  \param[in]  a_box   Region (in all BaseFabs)
+ *  \param[in]  a_dstComp
+ *                      Start index for components of this BaseFab
+ *  \param[in]  a_a     Multiplier of a_x
+ *  \param[in]  a_x     First BaseFab
+ *  \param[in]  a_xComp Start index for components of a_x
+ *  \param[in]  a_b     Multiplier of a_y
+ *  \param[in]  a_y     Second BaseFab
+ *  \param[in]  a_yComp Start index for components of a_y
+ *  \param[in]  a_numComp
+ *                      Number of components
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+void
+BaseFab<T, Layout>::lincomb(const Box&          a_box,
+                            const int           a_dstComp,
+                            const compute_type& a_a,
+                            const BaseFab&      a_x,
+                            const int           a_xComp,
+                            const compute_type& a_b,
+                            const BaseFab&      a_y,
+                            const int           a_yComp,
+                            const int           a_numComp)
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_x.box().contains(a_box) && a_y.box().contains(a_box));
+  CH_assert(a_dstComp >= 0 && (a_dstComp + a_numComp) <= m_ncomp);
+  CH_assert(a_xComp >= 0 && (a_xComp + a_numComp) <= a_x.ncomp());
+  CH_assert(a_yComp >= 0 && (a_yComp + a_numComp) <= a_y.ncomp());
+  mapRegion(*this, a_dstComp, a_x, a_xComp, a_y, a_yComp,
+            a_box, a_numComp,
+            [a_a, a_b](T& a_d,
+                       const compute_type a_xVal,
+                       const compute_type a_yVal)
+            {
+              a_d = product(a_a, a_xVal) + product(a_b, a_yVal);
+            });
+}
+
+/*--------------------------------------------------------------------*/
+//  Sum of components in a region
+/** The order of summation depends on the number of threads and the
+ *  SIMD width.
+ *  \param[in]  a_box   Region
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *  \return             Sum
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+typename BaseFab<T, Layout>::compute_type
+BaseFab<T, Layout>::sum(const Box& a_box,
+                        const int  a_startComp,
+                        const int  a_endComp) const
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  return sumRegion(*this, a_box, a_startComp, a_endComp,
+                   [](const compute_type a_x)
+                   {
+                     return a_x;
+                   });
+}
+
+/*--------------------------------------------------------------------*/
+//  Norm of components in a region
+/** \param[in]  a_box   Region
+ *  \param[in]  a_p     Type of norm
+ *                      0 - maximum absolute value
+ *                      1 - sum of absolute values
+ *                      2 - square root of the sum of squares
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *  \return             Norm (0 for an empty region)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+typename BaseFab<T, Layout>::compute_type
+BaseFab<T, Layout>::norm(const Box& a_box,
+                         const int  a_p,
+                         const int  a_startComp,
+                         const int  a_endComp) const
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  CH_assert(a_p >= 0 && a_p <= 2);
+  const auto absFn =
+    [](const compute_type a_x)
+    {
+      return absVal(a_x);
+    };
+  switch (a_p)
+    {
+    case 0:
+      return std::max(compute_type(0), maxRegion(*this, a_box, a_startComp, a_endComp,
+                                      absFn));
+    case 1:
+      return sumRegion(*this, a_box, a_startComp, a_endComp, absFn);
+    default:
+      return std::sqrt(sumRegion(*this, a_box, a_startComp, a_endComp,
+                                 [](const compute_type a_x)
+                                 {
+                                   return product(a_x, a_x);
+                                 }));
     }
 }
 
+/*--------------------------------------------------------------------*/
+//  Minimum of components in a region
+/** \param[in]  a_box   Region
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *  \return             Minimum (std::numeric_limits<compute_type>::max()
+ *                      for an empty region)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+typename BaseFab<T, Layout>::compute_type
+BaseFab<T, Layout>::min(const Box& a_box,
+                        const int  a_startComp,
+                        const int  a_endComp) const
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  return minRegion(*this, a_box, a_startComp, a_endComp);
+}
+
+/*--------------------------------------------------------------------*/
+//  Maximum of components in a region
+/** \param[in]  a_box   Region
+ *  \param[in]  a_startComp
+ *                      First component
+ *  \param[in]  a_endComp
+ *                      One past last component
+ *  \return             Maximum (std::numeric_limits<compute_type>::
+ *                      lowest() for an empty region)
+ *//*-----------------------------------------------------------------*/
+
+template <typename T, typename Layout>
+typename BaseFab<T, Layout>::compute_type
+BaseFab<T, Layout>::max(const Box& a_box,
+                        const int  a_startComp,
+                        const int  a_endComp) const
+{
+  CH_assert(m_box.contains(a_box));
+  CH_assert(a_startComp >= 0 && a_endComp <= m_ncomp);
+  return maxRegion(*this, a_box, a_startComp, a_endComp,
+                   [](const compute_type a_x)
+                   {
+                     return a_x;
+                   });
+}
+
 
 #ifdef USE_GPU
 /*--------------------------------------------------------------------*/
 //  Copy array to device
 /*--------------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::copyToDevice() const
+BaseFab<T, Layout>::copyToDevice() const
 
 {
   CU_SAFE_CALL(cudaMemcpy(m_dataSymbol.device,
@@ -456,9 +1718,9 @@ BaseFab<T>::copyToDevice() const
  *                      Stream index (defaults to default stream)
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 inline void
-BaseFab<T>::copyToDeviceAsync(cudaStream_t a_stream) const
+BaseFab<T, Layout>::copyToDeviceAsync(cudaStream_t a_stream) const
 {
   CU_SAFE_CALL(cudaMemcpyAsync(m_dataSymbol.device,
                                m_dataSymbol.host,
@@ -471,9 +1733,9 @@ BaseFab<T>::copyToDeviceAsync(cudaStream_t a_stream) const
 //  Copy array to host
 /*--------------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 inline void
-BaseFab<T>::copyToHost()
+BaseFab<T, Layout>::copyToHost()
 {
   CU_SAFE_CALL(cudaMemcpy(m_dataSymbol.host,
                           m_dataSymbol.device,
@@ -487,9 +1749,9 @@ BaseFab<T>::copyToHost()
  *                      Stream index (defaults to default stream)
  *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::copyToHostAsync(cudaStream_t a_stream)
+BaseFab<T, Layout>::copyToHostAsync(cudaStream_t a_stream)
 {
   CU_SAFE_CALL(cudaMemcpyAsync(m_dataSymbol.host,
                                m_dataSymbol.device,
@@ -501,30 +1763,65 @@ BaseFab<T>::copyToHostAsync(cudaStream_t a_stream)
 
 /*--------------------------------------------------------------------*/
 //  Set strides
-/*--------------------------------------------------------------------*/
+/** If s_padStride is set and the data is allocated, the x-stride is
+ *  rounded up to a multiple of s_alignment bytes so that every pencil
+ *  in x (and every component) starts on an aligned address.  Padding
+ *  only applies to LayoutSoA.  With interleaved layouts, m_stride[0]
+ *  is the stride between blocks of c_width cells and m_size is the
+ *  stride between components within a block.  The spatial strides are
+ *  int (a plane must have fewer than 2^31 elements) but m_size, the
+ *  size of a component, may be larger.
+ *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::setStride()
+BaseFab<T, Layout>::setStride()
 {
   const IntVect& lo = m_box.loVect();
   const IntVect& hi = m_box.hiVect();
   CH_assert(lo <= hi);
+  int nx = hi[0] - lo[0] + 1;
+  if (Layout::c_interleaved)
+    {
+      // Whole blocks in x
+      constexpr int width = Layout::c_width;
+      D_TERM(m_stride[0] = width*m_ncomp;,
+             m_stride[1] = m_stride[0]*((nx + width - 1)/width);,
+             m_stride[2] = m_stride[1]*(hi[1] - lo[1] + 1);)
+      CH_assert(m_stride[g_SpaceDim-1] ==
+                D_TERM((std::ptrdiff_t)width*m_ncomp,
+                       *((nx + width - 1)/width),
+                       *(hi[1] - lo[1] + 1)));
+      m_size = width;
+      return;
+    }
+  if (s_padStride && m_allocBy == AllocBy::array &&
+      s_alignment % sizeof(T) == 0)
+    {
+      const int numAlign = s_alignment/sizeof(T);
+      nx = ((nx + numAlign - 1)/numAlign)*numAlign;
+    }
   // Set strides
   D_TERM(m_stride[0] = 1;,
-         m_stride[1] = m_stride[0]*(hi[0] - lo[0] + 1);,
+         m_stride[1] = m_stride[0]*nx;,
          m_stride[2] = m_stride[1]*(hi[1] - lo[1] + 1);)
+  CH_assert(m_stride[g_SpaceDim-1] ==
+            D_TERM((std::ptrdiff_t)1, *nx, *(hi[1] - lo[1] + 1)));
   // Set size
-  m_size = m_stride[g_SpaceDim-1]*(hi[g_SpaceDim-1] - lo[g_SpaceDim-1] + 1);
+  m_size = ((std::ptrdiff_t)m_stride[g_SpaceDim-1])*
+    (hi[g_SpaceDim-1] - lo[g_SpaceDim-1] + 1);
 } 
 
 /*--------------------------------------------------------------------*/
 //  Allocate memory
-/*--------------------------------------------------------------------*/
+/** Data is aligned to s_alignment bytes and large BaseFabs are placed
+ *  on huge pages (see System::memalignLarge).  Elements are not
+ *  constructed so T must be trivial.
+ *//*-----------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::allocate()
+BaseFab<T, Layout>::allocate()
 {
   setStride();
   if (m_allocBy == AllocBy::array)
@@ -536,7 +1833,12 @@ BaseFab<T>::allocate()
       m_data = m_dataSymbol.host;
       CU_SAFE_CALL(cudaMalloc(&(m_dataSymbol.device), numBytes));
 #else
-      m_data = new T[size()];
+      void* addr = nullptr;
+      const int err = System::memalignLarge(&addr, s_alignment,
+                                            std::max(sizeBytes(), (size_t)1));
+      CH_assert(err == 0);
+      (void)err;
+      m_data = static_cast<T*>(addr);
 #endif
       FABDBG(std::cout << "BaseFab (" << std::setw(14) << m_data
              << "): new\n");
@@ -547,9 +1849,9 @@ BaseFab<T>::allocate()
 //  Deallocate memory
 /*--------------------------------------------------------------------*/
 
-template <typename T>
+template <typename T, typename Layout>
 void
-BaseFab<T>::deallocate()
+BaseFab<T, Layout>::deallocate()
 {
   if (m_allocBy == AllocBy::array && m_data != nullptr)
     {
@@ -560,7 +1862,7 @@ BaseFab<T>::deallocate()
       m_dataSymbol.host = nullptr;
       CU_SAFE_CALL(cudaFree(m_dataSymbol.device));
 #else
-      delete[] m_data;
+      System::freeLarge(m_data);
 #endif
       m_data = nullptr;
     }
@@ -578,3 +1880,32 @@ template class BaseFab<char>;
 template class BaseFab<int>;
 template class BaseFab<unsigned>;
 template class BaseFab<Real>;
+
+// Reduced-precision storage of Real
+#ifndef USE_SINGLE_PRECISION
+template class BaseFab<float>;
+#endif
+template class BaseFab<BFloat16>;
+
+// Interleaved layouts for Real, with the block widths of AVX and AVX-512
+// registers of double
+template class BaseFab<Real, LayoutAoS>;
+template class BaseFab<Real, LayoutAoSoA<4>>;
+template class BaseFab<Real, LayoutAoSoA<8>>;
+
+// Copies between layouts
+#define BASEFAB_COPY_LAYOUT(DstLayout, SrcLayout)                       \
+  template void BaseFab<Real, DstLayout>::copy<SrcLayout>(              \
+    const Box&, const int, const BaseFab<Real, SrcLayout>&, const Box&, \
+    const int, const int)
+#define BASEFAB_COPY_LAYOUTS(DstLayout)                                 \
+  BASEFAB_COPY_LAYOUT(DstLayout, LayoutSoA);                            \
+  BASEFAB_COPY_LAYOUT(DstLayout, LayoutAoS);                            \
+  BASEFAB_COPY_LAYOUT(DstLayout, LayoutAoSoA<4>);                       \
+  BASEFAB_COPY_LAYOUT(DstLayout, LayoutAoSoA<8>)
+BASEFAB_COPY_LAYOUTS(LayoutSoA);
+BASEFAB_COPY_LAYOUTS(LayoutAoS);
+BASEFAB_COPY_LAYOUTS(LayoutAoSoA<4>);
+BASEFAB_COPY_LAYOUTS(LayoutAoSoA<8>);
+#undef BASEFAB_COPY_LAYOUTS
+#undef BASEFAB_COPY_LAYOUT
@@ -0,0 +1,379 @@
+
+/******************************************************************************/
+/**
+ * \file BergerRigoutsos.cpp
+ *
+ * \brief Non-inline definitions for classes in BergerRigoutsos.H
+ *
+ *//*+*************************************************************************/
+
+#include <cstdlib>
+#include <algorithm>
+#include <numeric>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "BergerRigoutsos.H"
+#include "BoxIterator.H"
+#include "LayoutIterator.H"
+#include "LoadBalancer.H"
+
+
+/*******************************************************************************
+ *
+ * Class BergerRigoutsos: member definitions
+ *
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------*/
+//  Default constructor
+/** The fill ratio is 0.75 and box sizes are not limited
+ *//*-----------------------------------------------------------------*/
+
+BergerRigoutsos::BergerRigoutsos()
+  :
+  m_fillRatio(0.75),
+  m_maxBoxSize(IntVect::Zero)
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor
+/** \param[in]  a_fillRatio
+ *                      Minimum fraction of tagged cells in a box
+ *                      (0 < a_fillRatio <= 1)
+ *  \param[in]  a_maxBoxSize
+ *                      Maximum size of a box in each direction.  Zero
+ *                      in a direction for no limit.
+ *//*-----------------------------------------------------------------*/
+
+BergerRigoutsos::BergerRigoutsos(const Real     a_fillRatio,
+                                 const IntVect& a_maxBoxSize)
+{
+  define(a_fillRatio, a_maxBoxSize);
+}
+
+/*--------------------------------------------------------------------*/
+//  Weak construction
+/** \param[in]  a_fillRatio
+ *                      Minimum fraction of tagged cells in a box
+ *                      (0 < a_fillRatio <= 1)
+ *  \param[in]  a_maxBoxSize
+ *                      Maximum size of a box in each direction.  Zero
+ *                      in a direction for no limit.
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::define(const Real a_fillRatio, const IntVect& a_maxBoxSize)
+{
+  CH_assert(a_fillRatio > 0. && a_fillRatio <= 1.);
+  CH_assert(IntVect::Zero <= a_maxBoxSize);
+  m_fillRatio = a_fillRatio;
+  m_maxBoxSize = a_maxBoxSize;
+}
+
+/*--------------------------------------------------------------------*/
+//  Cluster a list of tagged cells
+/** \param[in]  a_tags  Tagged cells.  Duplicates are not allowed.  The
+ *                      order is modified.
+ *  \param[out] a_boxes Disjoint boxes covering all tagged cells
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::makeBoxes(std::vector<IntVect>& a_tags,
+                           std::vector<Box>&     a_boxes) const
+{
+  a_boxes.clear();
+  cluster(a_tags, 0, a_tags.size(), a_boxes);
+}
+
+/*--------------------------------------------------------------------*/
+//  Cluster the tagged cells in a BaseFab
+/** \param[in]  a_tags  Cells are tagged where component 0 is true
+ *  \param[out] a_boxes Disjoint boxes covering all tagged cells
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::makeBoxes(const BaseFab<bool>& a_tags,
+                           std::vector<Box>&    a_boxes) const
+{
+  std::vector<IntVect> tags;
+  for (BoxIterator bit(a_tags.box()); bit.ok(); ++bit)
+    {
+      if (a_tags(*bit, 0)) tags.push_back(*bit);
+    }
+  makeBoxes(tags, a_boxes);
+}
+
+/*--------------------------------------------------------------------*/
+//  Cluster the tagged cells in a LevelData (collective)
+/** Only the interior of each box is considered.  The tags are
+ *  gathered so all processes find the same boxes.
+ *  \param[in]  a_tags  Cells are tagged where component 0 is true
+ *  \param[out] a_boxes Disjoint boxes covering all tagged cells
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::makeBoxes(const LevelData<BaseFab<bool>>& a_tags,
+                           std::vector<Box>&               a_boxes) const
+{
+  const DisjointBoxLayout& dbl = a_tags.disjointBoxLayout();
+  std::vector<IntVect> tags;
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
+    {
+      const BaseFab<bool>& fab = a_tags[dit];
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          if (fab(*bit, 0)) tags.push_back(*bit);
+        }
+    }
+#ifdef USE_MPI
+  const int numProc = DisjointBoxLayout::numProc();
+  if (numProc > 1)
+    {
+      int numByte = tags.size()*sizeof(IntVect);
+      std::vector<int> counts(numProc);
+      MPI_Allgather(&numByte, 1, MPI_INT, counts.data(), 1, MPI_INT,
+                    MPI_COMM_WORLD);
+      std::vector<int> displs(numProc, 0);
+      std::partial_sum(counts.begin(), counts.end() - 1, displs.begin() + 1);
+      std::vector<IntVect> allTags(
+        (displs.back() + counts.back())/sizeof(IntVect));
+      MPI_Allgatherv(tags.data(), numByte, MPI_BYTE,
+                     allTags.data(), counts.data(), displs.data(), MPI_BYTE,
+                     MPI_COMM_WORLD);
+      tags.swap(allTags);
+    }
+#endif
+  makeBoxes(tags, a_boxes);
+}
+
+/*--------------------------------------------------------------------*/
+//  Build a layout from the tagged cells in a BaseFab
+/** \param[in]  a_tags  Cells are tagged where component 0 is true
+ *  \param[in]  a_domain
+ *                      Problem domain of the new layout
+ *  \param[out] a_dbl   Layout of boxes covering the tagged cells
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::makeLayout(const BaseFab<bool>& a_tags,
+                            const Box&           a_domain,
+                            DisjointBoxLayout&   a_dbl) const
+{
+  std::vector<Box> boxes;
+  makeBoxes(a_tags, boxes);
+  layoutBoxes(a_domain, boxes, a_dbl);
+}
+
+/*--------------------------------------------------------------------*/
+//  Build a layout from the tagged cells in a LevelData (collective)
+/** \param[in]  a_tags  Cells are tagged where component 0 is true
+ *  \param[out] a_dbl   Layout of boxes covering the tagged cells, in
+ *                      the same problem domain as a_tags
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::makeLayout(const LevelData<BaseFab<bool>>& a_tags,
+                            DisjointBoxLayout&              a_dbl) const
+{
+  std::vector<Box> boxes;
+  makeBoxes(a_tags, boxes);
+  layoutBoxes(a_tags.disjointBoxLayout().problemDomain(), boxes, a_dbl);
+}
+
+/*--------------------------------------------------------------------*/
+//  Build a layout from boxes with a balanced process assignment
+/** The cost of each box is its number of cells.  Boxes are assigned
+ *  to nodes and processes with LoadBalancer::partitionNodes.  Use the
+ *  maximum box size to obtain enough boxes for a good balance.
+ *  \param[in]  a_domain
+ *                      Problem domain
+ *  \param[in]  a_boxes Disjoint boxes in the domain
+ *  \param[out] a_dbl   Layout of the boxes
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::layoutBoxes(const Box&              a_domain,
+                             const std::vector<Box>& a_boxes,
+                             DisjointBoxLayout&      a_dbl)
+{
+  const DisjointBoxLayout dbl(a_domain, a_boxes,
+                              std::vector<int>(a_boxes.size(), 0));
+  if (a_boxes.empty())
+    {
+      a_dbl = dbl;
+      return;
+    }
+  std::vector<double> cost(dbl.size());
+  for (int idx = 0; idx != dbl.size(); ++idx)
+    {
+      cost[idx] = dbl.getLinear(idx).box.size();
+    }
+  std::vector<int> procs;
+  LoadBalancer::partitionNodes(dbl, cost, DisjointBoxLayout::procNode(),
+                               procs);
+  a_dbl.defineReassign(dbl, procs);
+}
+
+/*--------------------------------------------------------------------*/
+//  Recursively cluster a range of tagged cells
+/** \param[in]  a_tags  Tagged cells.  The range is reordered so that
+ *                      the cells on each side of a cut are contiguous.
+ *  \param[in]  a_beg   Begin of the range
+ *  \param[in]  a_end   One past the end of the range
+ *  \param[out] a_boxes Accepted boxes are added
+ *//*-----------------------------------------------------------------*/
+
+void
+BergerRigoutsos::cluster(std::vector<IntVect>& a_tags,
+                         const int             a_beg,
+                         const int             a_end,
+                         std::vector<Box>&     a_boxes) const
+{
+  if (a_beg == a_end) return;
+
+//--Bounding box and signatures of the tags
+
+  IntVect lo = a_tags[a_beg];
+  IntVect hi = a_tags[a_beg];
+  for (int i = a_beg + 1; i != a_end; ++i)
+    {
+      lo.min(a_tags[i]);
+      hi.max(a_tags[i]);
+    }
+  const Box bound(lo, hi);
+  const IntVect dims = bound.dimensions();
+  std::vector<int> sig[g_SpaceDim];
+  for (int dir = 0; dir != g_SpaceDim; ++dir)
+    {
+      sig[dir].assign(dims[dir], 0);
+    }
+  for (int i = a_beg; i != a_end; ++i)
+    {
+      for (int dir = 0; dir != g_SpaceDim; ++dir)
+        {
+          ++sig[dir][a_tags[i][dir] - lo[dir]];
+        }
+    }
+
+//--Accept the box if it is efficient and small enough
+
+  const bool efficient = (a_end - a_beg) >= m_fillRatio*bound.size();
+  int bigDir = -1;                    // Direction most exceeding max size
+  int bigChunk = 1;
+  for (int dir = 0; dir != g_SpaceDim; ++dir)
+    {
+      if (m_maxBoxSize[dir] > 0)
+        {
+          const int numChunk =
+            (dims[dir] + m_maxBoxSize[dir] - 1)/m_maxBoxSize[dir];
+          if (numChunk > bigChunk)
+            {
+              bigDir = dir;
+              bigChunk = numChunk;
+            }
+        }
+    }
+  if (efficient && bigDir < 0)
+    {
+      a_boxes.push_back(bound);
+      return;
+    }
+
+//--Find a cut.  Cells with index < cut in direction dir are on the low side.
+
+  int dir = -1;
+  int cut = 0;
+  if (efficient)
+    {
+      // Chop to the maximum box size
+      dir = bigDir;
+      cut = lo[dir] + m_maxBoxSize[dir]*(bigChunk/2);
+    }
+  else if (!findCut(sig, lo, dir, cut))
+    {
+      // Bisect the longest direction
+      dir = 0;
+      for (int d = 1; d != g_SpaceDim; ++d)
+        {
+          if (dims[d] > dims[dir]) dir = d;
+        }
+      cut = lo[dir] + dims[dir]/2;
+    }
+  CH_assert(cut > lo[dir] && cut <= hi[dir]);
+
+  const int mid = std::partition(a_tags.begin() + a_beg,
+                                 a_tags.begin() + a_end,
+                                 [dir, cut](const IntVect& a_iv)
+                                 {
+                                   return a_iv[dir] < cut;
+                                 }) - a_tags.begin();
+  cluster(a_tags, a_beg, mid, a_boxes);
+  cluster(a_tags, mid, a_end, a_boxes);
+}
+
+/*--------------------------------------------------------------------*/
+//  Find a cut at a hole or inflection point of the signatures
+/** A hole (a plane with no tags) is preferred, choosing the one
+ *  furthest from the ends of the box.  Otherwise, the cut is placed
+ *  at the largest change in sign of the second derivative of a
+ *  signature.
+ *  \param[in]  a_sig   Signature (number of tags in each plane) for
+ *                      each direction
+ *  \param[in]  a_lo    Lower corner of the bounding box
+ *  \param[out] a_dir   Direction of the cut
+ *  \param[out] a_cut   Cells with index < a_cut in a_dir are on the
+ *                      low side
+ *  \return             T - a cut was found
+ *//*-----------------------------------------------------------------*/
+
+bool
+BergerRigoutsos::findCut(const std::vector<int>* a_sig,
+                         const IntVect&          a_lo,
+                         int&                    a_dir,
+                         int&                    a_cut)
+{
+  // Holes (signatures are never zero at the ends of the bounding box)
+  int bestDist = 0;
+  for (int dir = 0; dir != g_SpaceDim; ++dir)
+    {
+      const std::vector<int>& sig = a_sig[dir];
+      const int n = sig.size();
+      for (int i = 1; i < n - 1; ++i)
+        {
+          const int dist = std::min(i, n - 1 - i);
+          if (sig[i] == 0 && dist > bestDist)
+            {
+              bestDist = dist;
+              a_dir = dir;
+              a_cut = a_lo[dir] + i;
+            }
+        }
+    }
+  if (bestDist > 0) return true;
+
+  // Inflection points.  The cut is between i and i+1 where the Laplacian
+  // changes sign.
+  int bestJump = 0;
+  for (int dir = 0; dir != g_SpaceDim; ++dir)
+    {
+      const std::vector<int>& sig = a_sig[dir];
+      const int n = sig.size();
+      for (int i = 1; i < n - 2; ++i)
+        {
+          const int lap0 = sig[i-1] - 2*sig[i] + sig[i+1];
+          const int lap1 = sig[i] - 2*sig[i+1] + sig[i+2];
+          const int jump = std::abs(lap1 - lap0);
+          if (lap0*lap1 < 0 && jump > bestJump)
+            {
+              bestJump = jump;
+              a_dir = dir;
+              a_cut = a_lo[dir] + i + 1;
+            }
+        }
+    }
+  return (bestJump > 0);
+}
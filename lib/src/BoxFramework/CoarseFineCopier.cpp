@@ -0,0 +1,460 @@
+
+/******************************************************************************/
+/**
+ * \file CoarseFineCopier.cpp
+ *
+ * \brief Non-inline definitions for classes in CoarseFineCopier.H
+ *
+ *//*+*************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "CoarseFineCopier.H"
+
+#ifdef USE_MPI
+namespace
+{
+
+/// Tag for all coarse-fine messages (the largest guaranteed by MPI)
+constexpr int c_mpiTag = 32767;
+
+/// Largest message in bytes (MPI counts are int)
+constexpr size_t c_maxMsgBytes = std::numeric_limits<int>::max();
+
+/// Number of cells in a list of regions
+size_t
+numCells(const std::vector<CoarseFineCopier::Item>& a_items);
+
+/// Post a buffer as one or more messages
+void
+postMessages(std::vector<Real>&        a_buf,
+             const int                 a_proc,
+             const bool                a_send,
+             std::vector<MPI_Request>& a_requests);
+
+/// Wait for all messages or abort
+void
+waitAll(std::vector<MPI_Request>& a_requests);
+
+}
+#endif
+
+
+/*******************************************************************************
+ *
+ * Class CoarseFineCopier: member definitions
+ *
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------*/
+//  Default constructor
+/*--------------------------------------------------------------------*/
+
+CoarseFineCopier::CoarseFineCopier()
+  :
+  m_crDbl(),
+  m_fnDbl(),
+  m_refRatio(1),
+  m_numGrow(0),
+  m_localItems(),
+  m_crProcs(),
+  m_crItems(),
+  m_fnProcs(),
+  m_fnItems()
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor
+/** \param[in]  a_crDbl Coarse layout
+ *  \param[in]  a_fnDbl Fine layout
+ *  \param[in]  a_refRatio
+ *                      Refinement ratio from the coarse to the fine
+ *                      layout
+ *  \param[in]  a_numGrow
+ *                      Number of coarse cells to grow the coarsened
+ *                      fine boxes by
+ *//*-----------------------------------------------------------------*/
+
+CoarseFineCopier::CoarseFineCopier(const DisjointBoxLayout& a_crDbl,
+                                   const DisjointBoxLayout& a_fnDbl,
+                                   const int                a_refRatio,
+                                   const int                a_numGrow)
+{
+  define(a_crDbl, a_fnDbl, a_refRatio, a_numGrow);
+}
+
+/*--------------------------------------------------------------------*/
+//  Weak construction
+/** Both processes of every message find the same regions: the
+ *  receiving side from its fine boxes and the sending side from its
+ *  coarse boxes.
+ *  \param[in]  a_crDbl Coarse layout
+ *  \param[in]  a_fnDbl Fine layout.  The domain should be the coarse
+ *                      domain refined by a_refRatio.
+ *  \param[in]  a_refRatio
+ *                      Refinement ratio from the coarse to the fine
+ *                      layout
+ *  \param[in]  a_numGrow
+ *                      Number of coarse cells to grow the coarsened
+ *                      fine boxes by
+ *//*-----------------------------------------------------------------*/
+
+void
+CoarseFineCopier::define(const DisjointBoxLayout& a_crDbl,
+                         const DisjointBoxLayout& a_fnDbl,
+                         const int                a_refRatio,
+                         const int                a_numGrow)
+{
+  CH_assert(a_refRatio > 0);
+  CH_assert(a_numGrow >= 0);
+  m_crDbl = a_crDbl;
+  m_fnDbl = a_fnDbl;
+  m_refRatio = a_refRatio;
+  m_numGrow = a_numGrow;
+  m_localItems.clear();
+  m_crProcs.clear();
+  m_crItems.clear();
+  m_fnProcs.clear();
+  m_fnItems.clear();
+
+  const int procID = DisjointBoxLayout::procID();
+  std::map<int, std::vector<Item>> crItems;
+  std::map<int, std::vector<Item>> fnItems;
+  std::vector<int> globalIdx;
+
+  // Regions of coarse boxes in the buffers of local fine boxes
+  for (DataIterator dit(m_fnDbl); dit.ok(); ++dit)
+    {
+      const Box bufBox = bufferBox(*dit);
+      m_crDbl.findIntersecting(bufBox, globalIdx);
+      for (const int crIdx : globalIdx)
+        {
+          const auto crEntry = m_crDbl.getLinear(crIdx);
+          Box region = crEntry.box;
+          region &= bufBox;
+          const Item item{ crIdx, (*dit).globalIndex(), region };
+          if (crEntry.proc == procID)
+            {
+              m_localItems.push_back(item);
+            }
+          else
+            {
+              crItems[crEntry.proc].push_back(item);
+            }
+        }
+    }
+
+  // Regions of local coarse boxes in the buffers of remote fine boxes.  A
+  // buffer overlaps a coarse box only if the fine box overlaps the refined
+  // coarse box grown by m_numGrow.
+  for (DataIterator dit(m_crDbl); dit.ok(); ++dit)
+    {
+      const Box crBox = m_crDbl[dit];
+      Box search(crBox);
+      search.grow(m_numGrow);
+      search.refine(m_refRatio);
+      m_fnDbl.findIntersecting(search, globalIdx);
+      for (const int fnIdx : globalIdx)
+        {
+          const auto fnEntry = m_fnDbl.getLinear(fnIdx);
+          if (fnEntry.proc == procID) continue;
+          Box region = fnEntry.box;
+          region.coarsen(m_refRatio);
+          region.grow(m_numGrow);
+          region &= crBox;
+          if (!region.isEmpty())
+            {
+              fnItems[fnEntry.proc].push_back(
+                Item{ (*dit).globalIndex(), fnIdx, region });
+            }
+        }
+    }
+
+  sortItems(m_localItems);
+  for (auto& procItems : crItems)
+    {
+      m_crProcs.push_back(procItems.first);
+      sortItems(procItems.second);
+      m_crItems.push_back(std::move(procItems.second));
+    }
+  for (auto& procItems : fnItems)
+    {
+      m_fnProcs.push_back(procItems.first);
+      sortItems(procItems.second);
+      m_fnItems.push_back(std::move(procItems.second));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Size the buffers for all local fine boxes
+/** \param[out] a_buffers
+ *                      Buffers indexed by the local index of the fine
+ *                      boxes and set to zero
+ *  \param[in]  a_ncomp Number of components
+ *//*-----------------------------------------------------------------*/
+
+void
+CoarseFineCopier::defineBuffers(std::vector<FArrayBox>& a_buffers,
+                                const int               a_ncomp) const
+{
+  a_buffers.clear();
+  a_buffers.resize(m_fnDbl.localSize());
+  for (DataIterator dit(m_fnDbl); dit.ok(); ++dit)
+    {
+      FArrayBox& buffer = a_buffers[(*dit).localIndex()];
+      buffer.define(bufferBox(*dit), a_ncomp);
+      buffer.setVal(0.);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Fill the buffers from coarse data (collective)
+/** Only parts of the buffers covered by coarse boxes are modified
+ *  \param[in]  a_crData
+ *                      Data on the coarse layout
+ *  \param[out] a_buffers
+ *                      Buffers from defineBuffers with the same number
+ *                      of components as a_crData
+ *//*-----------------------------------------------------------------*/
+
+void
+CoarseFineCopier::copyToFine(const LevelData<FArrayBox>& a_crData,
+                             std::vector<FArrayBox>&     a_buffers) const
+{
+  CH_assert(a_crData.disjointBoxLayout().tag() == m_crDbl.tag());
+  CH_assert((int)a_buffers.size() == m_fnDbl.localSize());
+  const int crBeg = m_crDbl.localIdxBegin();
+  const int fnBeg = m_fnDbl.localIdxBegin();
+
+#ifdef USE_MPI
+  const int ncomp = a_crData.ncomp();
+  std::vector<MPI_Request> requests;
+  requests.reserve(m_crProcs.size() + m_fnProcs.size());
+
+  // Post receives from processes with coarse boxes
+  std::vector<std::vector<Real>> recvBuf(m_crProcs.size());
+  for (int iProc = 0, iProc_end = m_crProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      recvBuf[iProc].resize(ncomp*numCells(m_crItems[iProc]));
+      postMessages(recvBuf[iProc], m_crProcs[iProc], false, requests);
+    }
+
+  // Pack and send local coarse data
+  std::vector<std::vector<Real>> sendBuf(m_fnProcs.size());
+  for (int iProc = 0, iProc_end = m_fnProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      sendBuf[iProc].resize(ncomp*numCells(m_fnItems[iProc]));
+      Real* p = sendBuf[iProc].data();
+      for (const Item& item : m_fnItems[iProc])
+        {
+          a_crData[BoxIndex(item.crIdx, item.crIdx - crBeg)].linearOut(
+            p, item.region, 0, ncomp);
+          p += ncomp*item.region.size();
+        }
+      postMessages(sendBuf[iProc], m_fnProcs[iProc], true, requests);
+    }
+#endif
+
+  // Local copies
+  for (const Item& item : m_localItems)
+    {
+      a_buffers[item.fnIdx - fnBeg].copy(
+        item.region, a_crData[BoxIndex(item.crIdx, item.crIdx - crBeg)]);
+    }
+
+#ifdef USE_MPI
+  waitAll(requests);
+  for (int iProc = 0, iProc_end = m_crProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      const Real* p = recvBuf[iProc].data();
+      for (const Item& item : m_crItems[iProc])
+        {
+          a_buffers[item.fnIdx - fnBeg].linearIn(p, item.region, 0, ncomp);
+          p += ncomp*item.region.size();
+        }
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+//  Write the buffers into coarse data (collective)
+/** \param[in]  a_buffers
+ *                      Buffers from defineBuffers with the same number
+ *                      of components as a_crData
+ *  \param[out] a_crData
+ *                      Data on the coarse layout.  Valid cells under
+ *                      the buffers are overwritten.
+ *//*-----------------------------------------------------------------*/
+
+void
+CoarseFineCopier::copyToCoarse(const std::vector<FArrayBox>& a_buffers,
+                               LevelData<FArrayBox>&         a_crData) const
+{
+  CH_assert(a_crData.disjointBoxLayout().tag() == m_crDbl.tag());
+  CH_assert((int)a_buffers.size() == m_fnDbl.localSize());
+  const int crBeg = m_crDbl.localIdxBegin();
+  const int fnBeg = m_fnDbl.localIdxBegin();
+
+#ifdef USE_MPI
+  const int ncomp = a_crData.ncomp();
+  std::vector<MPI_Request> requests;
+  requests.reserve(m_crProcs.size() + m_fnProcs.size());
+
+  // Post receives from processes with buffers
+  std::vector<std::vector<Real>> recvBuf(m_fnProcs.size());
+  for (int iProc = 0, iProc_end = m_fnProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      recvBuf[iProc].resize(ncomp*numCells(m_fnItems[iProc]));
+      postMessages(recvBuf[iProc], m_fnProcs[iProc], false, requests);
+    }
+
+  // Pack and send local buffers
+  std::vector<std::vector<Real>> sendBuf(m_crProcs.size());
+  for (int iProc = 0, iProc_end = m_crProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      sendBuf[iProc].resize(ncomp*numCells(m_crItems[iProc]));
+      Real* p = sendBuf[iProc].data();
+      for (const Item& item : m_crItems[iProc])
+        {
+          a_buffers[item.fnIdx - fnBeg].linearOut(p, item.region, 0, ncomp);
+          p += ncomp*item.region.size();
+        }
+      postMessages(sendBuf[iProc], m_crProcs[iProc], true, requests);
+    }
+#endif
+
+  // Local copies
+  for (const Item& item : m_localItems)
+    {
+      a_crData[BoxIndex(item.crIdx, item.crIdx - crBeg)].copy(
+        item.region, a_buffers[item.fnIdx - fnBeg]);
+    }
+
+#ifdef USE_MPI
+  waitAll(requests);
+  for (int iProc = 0, iProc_end = m_fnProcs.size(); iProc != iProc_end;
+       ++iProc)
+    {
+      const Real* p = recvBuf[iProc].data();
+      for (const Item& item : m_fnItems[iProc])
+        {
+          a_crData[BoxIndex(item.crIdx, item.crIdx - crBeg)].linearIn(
+            p, item.region, 0, ncomp);
+          p += ncomp*item.region.size();
+        }
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+//  Sort items into the order both sides of a message agree on
+/** \param[in]  a_items Items to sort
+ *  \param[out] a_items Sorted by fine and then coarse global index
+ *//*-----------------------------------------------------------------*/
+
+void
+CoarseFineCopier::sortItems(std::vector<Item>& a_items)
+{
+  std::sort(a_items.begin(), a_items.end(),
+            [](const Item& a_x, const Item& a_y)
+            {
+              return std::tie(a_x.fnIdx, a_x.crIdx) <
+                std::tie(a_y.fnIdx, a_y.crIdx);
+            });
+}
+
+#ifdef USE_MPI
+namespace
+{
+
+/*--------------------------------------------------------------------*/
+//  Number of cells in a list of regions
+/*--------------------------------------------------------------------*/
+
+size_t
+numCells(const std::vector<CoarseFineCopier::Item>& a_items)
+{
+  size_t num = 0;
+  for (const CoarseFineCopier::Item& item : a_items)
+    {
+      num += item.region.size();
+    }
+  return num;
+}
+
+/*--------------------------------------------------------------------*/
+//  Post a buffer as one or more messages
+/** All data between two processes is in one buffer, which may be larger
+ *  than an int count.  It is then split into several messages with the
+ *  same tag.  Both sides split the same number of bytes and messages
+ *  between two processes do not overtake, so the pieces match.
+ *  \param[in]  a_buf   Buffer to send or receive into
+ *  \param[in]  a_proc  The other process
+ *  \param[in]  a_send  T - send, F - receive
+ *  \param[out] a_requests
+ *                      A request is appended for each message
+ *//*-----------------------------------------------------------------*/
+
+void
+postMessages(std::vector<Real>&        a_buf,
+             const int                 a_proc,
+             const bool                a_send,
+             std::vector<MPI_Request>& a_requests)
+{
+  char *const buf = reinterpret_cast<char*>(a_buf.data());
+  const size_t bytes = a_buf.size()*sizeof(Real);
+  size_t offset = 0;
+  do
+    {
+      const int count = (int)std::min(bytes - offset, c_maxMsgBytes);
+      a_requests.emplace_back();
+      if (a_send)
+        {
+          MPI_Isend(buf + offset, count, MPI_BYTE, a_proc, c_mpiTag,
+                    MPI_COMM_WORLD, &a_requests.back());
+        }
+      else
+        {
+          MPI_Irecv(buf + offset, count, MPI_BYTE, a_proc, c_mpiTag,
+                    MPI_COMM_WORLD, &a_requests.back());
+        }
+      offset += count;
+    }
+  while (offset < bytes);
+}
+
+/*--------------------------------------------------------------------*/
+//  Wait for all messages or abort
+/*--------------------------------------------------------------------*/
+
+void
+waitAll(std::vector<MPI_Request>& a_requests)
+{
+  if (a_requests.empty()) return;
+  int mpierr = MPI_Waitall(a_requests.size(), a_requests.data(),
+                           MPI_STATUSES_IGNORE);
+  if (mpierr)
+    {
+      std::cout << "Error waiting for coarse-fine messages on process "
+                << DisjointBoxLayout::procID() << std::endl;
+      abort();
+    }
+}
+
+}
+#endif
@@ -8,6 +8,11 @@
  *//*+*************************************************************************/
 
 #include <cstdio>
+#include <algorithm>
+#include <numeric>
+#include <istream>
+#include <ostream>
+#include <type_traits>
 
 #ifdef USE_MPI
 #include <mpi.h>
@@ -36,6 +41,8 @@
 
 int DisjointBoxLayout::s_numProc = 1;
 int DisjointBoxLayout::s_procID = 0;
+int DisjointBoxLayout::s_numNode = 1;
+std::vector<int> DisjointBoxLayout::s_procNode(1, 0);
 
 
 /*******************************************************************************
@@ -52,8 +59,12 @@ DisjointBoxLayout::DisjointBoxLayout()
   :
   m_stride(IntVect::Zero),
   m_numBox(IntVect::Zero),
+  m_boxSize(IntVect::Zero),
   m_size(0),
   m_boxes(),
+  m_boxPerProc(0),
+  m_globalToLattice(),
+  m_latticeToGlobal(),
   m_localIdxBeg(0),
   m_numLocalBox(0)
 {
@@ -78,6 +89,37 @@ DisjointBoxLayout::DisjointBoxLayout(const Box&     a_domain,
   define(a_domain, a_maxBoxSize);
 }
 
+/*--------------------------------------------------------------------*/
+//  Constructor with a process assignment for each box
+/** \param[in] a_domain The problem domain
+ *  \param[in] a_maxBoxSize
+ *                      Size of each box in each direction
+ *  \param[in] a_procs  Process assigned to each box, in lattice
+ *                      (Fortran) ordering
+ *//*-----------------------------------------------------------------*/
+
+DisjointBoxLayout::DisjointBoxLayout(const Box&              a_domain,
+                                     const IntVect&          a_maxBoxSize,
+                                     const std::vector<int>& a_procs)
+{
+  define(a_domain, a_maxBoxSize, a_procs);
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor from an explicit list of boxes and processes
+/** \param[in] a_domain The problem domain
+ *  \param[in] a_boxes  Disjoint boxes inside the domain.  They need
+ *                      not cover the domain or have the same size.
+ *  \param[in] a_procs  Process assigned to each box
+ *//*-----------------------------------------------------------------*/
+
+DisjointBoxLayout::DisjointBoxLayout(const Box&              a_domain,
+                                     const std::vector<Box>& a_boxes,
+                                     const std::vector<int>& a_procs)
+{
+  define(a_domain, a_boxes, a_procs);
+}
+
 /*--------------------------------------------------------------------*/
 //  Define (weak construction)
 /** \param[in] a_domain The problem domain
@@ -86,15 +128,385 @@ DisjointBoxLayout::DisjointBoxLayout(const Box&     a_domain,
  *  The problem domain is partitioned into boxes, each having maximum
  *  size in a dimension given by a_maxBoxSize.  Must fit evenly.  
  *  Leading boxes in each direction usually have
- *  a_maxBoxSize dimensions.
+ *  a_maxBoxSize dimensions.  An equal number of boxes is assigned to
+ *  each process, in lattice order.  The boxes are implicit: each box
+ *  and process is computed from the global index and no array of
+ *  boxes is stored.
  *//*-----------------------------------------------------------------*/
 
 void
 DisjointBoxLayout::define(const Box& a_domain, const IntVect& a_maxBoxSize)
+{
+  defineLattice(a_domain, a_maxBoxSize);
+
+  // Number of boxes per processor
+  const int boxPerProc = m_size/numProc();
+  // Make sure the boxes fit evenly into the processors
+  CH_assert(m_size == boxPerProc*numProc());
+  defineImplicit(boxPerProc);
+}
+
+/*--------------------------------------------------------------------*/
+//  Define with a process assignment for each box (weak construction)
+/** \param[in] a_domain The problem domain
+ *  \param[in] a_maxBoxSize
+ *                      Size of each box in each direction.  Must fit
+ *                      evenly.
+ *  \param[in] a_procs  Process assigned to each box, in lattice
+ *                      (Fortran) ordering
+ *  Boxes are stored (and given global indices) so that the boxes on
+ *  each process are contiguous.  Among the boxes on a process, lattice
+ *  ordering is retained.  If the assignment is the same as that made
+ *  by define(a_domain, a_maxBoxSize), the boxes are implicit.
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::define(const Box&              a_domain,
+                          const IntVect&          a_maxBoxSize,
+                          const std::vector<int>& a_procs)
+{
+  defineLattice(a_domain, a_maxBoxSize);
+  CH_assert((int)a_procs.size() == m_size);
+
+//--Use implicit boxes if there are an equal number of boxes on each process,
+//--assigned in lattice order
+
+  const int boxPerProc = m_size/numProc();
+  if (boxPerProc > 0 && m_size == boxPerProc*numProc())
+    {
+      bool implicit = true;
+      for (int idx = 0; idx != m_size; ++idx)
+        {
+          if (a_procs[idx] != idx/boxPerProc)
+            {
+              implicit = false;
+              break;
+            }
+        }
+      if (implicit)
+        {
+          defineImplicit(boxPerProc);
+          return;
+        }
+    }
+
+//--Order the boxes by process.  If the assignment already follows lattice
+//--ordering, no maps are required.
+
+  if (!std::is_sorted(a_procs.begin(), a_procs.end()))
+    {
+      m_globalToLattice = std::make_shared<std::vector<int>>(m_size);
+      m_latticeToGlobal = std::make_shared<std::vector<int>>(m_size);
+      std::vector<int>& globalToLattice = *m_globalToLattice;
+      std::iota(globalToLattice.begin(), globalToLattice.end(), 0);
+      std::stable_sort(globalToLattice.begin(), globalToLattice.end(),
+                       [&a_procs](const int a_i, const int a_j)
+                       {
+                         return a_procs[a_i] < a_procs[a_j];
+                       });
+      for (int idx = 0; idx != m_size; ++idx)
+        {
+          (*m_latticeToGlobal)[globalToLattice[idx]] = idx;
+        }
+    }
+
+//--Define the individual boxes and processor assignments for 'm_boxes'
+
+  m_boxes = std::make_shared<BoxList>();
+  m_boxes->entries.resize(m_size);
+  m_localIdxBeg = 0;
+  m_numLocalBox = 0;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      // Location of the box in the lattice
+      const int linearIdx = latticeIndex(idx);
+      const int proc = a_procs[linearIdx];
+      CH_assert(proc >= 0 && proc < numProc());
+      BoxEntry& entry = m_boxes->entries[idx];
+      entry.box = latticeBox(linearIdx);
+      entry.proc = proc;
+      if (proc == procID())
+        {
+          if (m_numLocalBox == 0)
+            {
+              m_localIdxBeg = idx;
+            }
+          ++m_numLocalBox;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Define from an explicit list of boxes and processes (weak
+//  construction)
+/** \param[in] a_domain The problem domain
+ *  \param[in] a_boxes  Disjoint boxes inside the domain.  They need
+ *                      not cover the domain or have the same size.
+ *  \param[in] a_procs  Process assigned to each box
+ *  Boxes are stored (and given global indices) so that the boxes on
+ *  each process are contiguous.  Among the boxes on a process, the
+ *  given ordering is retained.  Neighbours are found by intersecting
+ *  boxes instead of with lattice strides.
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::define(const Box&              a_domain,
+                          const std::vector<Box>& a_boxes,
+                          const std::vector<int>& a_procs)
+{
+  CH_assert(a_boxes.size() == a_procs.size());
+  m_domain = a_domain;
+  m_stride = IntVect::Zero;
+  m_numBox = IntVect::Zero;
+  m_boxSize = IntVect::Zero;
+  m_size = a_boxes.size();
+  m_boxPerProc = 0;
+  m_globalToLattice.reset();
+  m_latticeToGlobal.reset();
+
+  std::vector<int> order(m_size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&a_procs](const int a_i, const int a_j)
+                   {
+                     return a_procs[a_i] < a_procs[a_j];
+                   });
+
+  m_boxes = std::make_shared<BoxList>();
+  m_boxes->entries.resize(m_size);
+  m_localIdxBeg = 0;
+  m_numLocalBox = 0;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      BoxEntry& entry = m_boxes->entries[idx];
+      entry.box = a_boxes[order[idx]];
+      entry.proc = a_procs[order[idx]];
+      CH_assert(!entry.box.isEmpty() && a_domain.contains(entry.box));
+      CH_assert(entry.proc >= 0 && entry.proc < numProc());
+      if (entry.proc == procID())
+        {
+          if (m_numLocalBox == 0)
+            {
+              m_localIdxBeg = idx;
+            }
+          ++m_numLocalBox;
+        }
+    }
+  defineBins();
+#ifndef RELEASE
+  // Later operations (fusing, mapping indices, and building Copiers)
+  // assume the boxes are disjoint: each must only intersect itself
+  std::vector<int> intersecting;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      findIntersecting(m_boxes->entries[idx].box, intersecting);
+      CH_assert(intersecting.size() == 1 && intersecting[0] == idx);
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+//  Define with the boxes of another layout and a new process
+//  assignment
+/** \param[in] a_dbl    Layout providing the boxes
+ *  \param[in] a_procs  New process for each box, indexed by the global
+ *                      index of the box in a_dbl
+ *  The global indices of boxes in this layout will generally differ
+ *  from those in a_dbl.  Use mapIndices to relate the two.
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineReassign(const DisjointBoxLayout& a_dbl,
+                                  const std::vector<int>&  a_procs)
+{
+  CH_assert((int)a_procs.size() == a_dbl.size());
+  if (!a_dbl.isLattice())
+    {
+      std::vector<Box> boxes(a_dbl.size());
+      for (int idx = 0; idx != a_dbl.size(); ++idx)
+        {
+          boxes[idx] = a_dbl.getLinear(idx).box;
+        }
+      define(a_dbl.m_domain, boxes, a_procs);
+      return;
+    }
+  std::vector<int> latticeProcs(a_dbl.size());
+  for (int idx = 0; idx != a_dbl.size(); ++idx)
+    {
+      latticeProcs[a_dbl.latticeIndex(idx)] = a_procs[idx];
+    }
+  define(a_dbl.m_domain, a_dbl.m_boxSize, latticeProcs);
+}
+
+/*--------------------------------------------------------------------*/
+//  Define by fusing the boxes on each process that tile a rectangle
+/** If the boxes on a process exactly cover their bounding box, they
+ *  are replaced by the bounding box.  Otherwise the boxes on that
+ *  process are retained.  Kernels can then run over a whole block
+ *  and exchanges are only required between processes.  Per-box
+ *  access to the data is still available through views (see
+ *  LevelData::defineView).
+ *  \param[in] a_dbl    Layout providing the boxes and processes
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineFused(const DisjointBoxLayout& a_dbl)
+{
+  // Bounding box and number of cells of the boxes on each process
+  const int nproc = numProc();
+  std::vector<IntVect> lo(nproc, IntVect::Zero);
+  std::vector<IntVect> hi(nproc, IntVect::Zero);
+  std::vector<long long> numCell(nproc, 0);
+  for (int idx = 0; idx != a_dbl.size(); ++idx)
+    {
+      const BoxEntry entry = a_dbl.getLinear(idx);
+      if (numCell[entry.proc] == 0)
+        {
+          lo[entry.proc] = entry.box.loVect();
+          hi[entry.proc] = entry.box.hiVect();
+        }
+      else
+        {
+          lo[entry.proc].min(entry.box.loVect());
+          hi[entry.proc].max(entry.box.hiVect());
+        }
+      numCell[entry.proc] += entry.box.size();
+    }
+
+  // Boxes are disjoint so they tile the bounding box if the number of
+  // cells is the same
+  std::vector<Box> boxes;
+  std::vector<int> procs;
+  std::vector<bool> added(nproc, false);
+  for (int idx = 0; idx != a_dbl.size(); ++idx)
+    {
+      const BoxEntry entry = a_dbl.getLinear(idx);
+      const Box bound(lo[entry.proc], hi[entry.proc]);
+      if (numCell[entry.proc] == (long long)bound.size())
+        {
+          if (added[entry.proc]) continue;
+          added[entry.proc] = true;
+          boxes.push_back(bound);
+        }
+      else
+        {
+          boxes.push_back(entry.box);
+        }
+      procs.push_back(entry.proc);
+    }
+  define(a_dbl.m_domain, boxes, procs);
+}
+
+/*--------------------------------------------------------------------*/
+//  Define with only the active boxes of another layout (collective)
+/** Inactive boxes (e.g., entirely solid in a porous medium) are left
+ *  out of the layout.  LevelData on this layout therefore allocates
+ *  no storage for them, iterators never visit them, and Copiers
+ *  build no motion items to or from them.  Memory, time, and message
+ *  volume scale with the active boxes instead of the bounding domain.
+ *  Ghost cells next to an inactive box are not filled by an exchange
+ *  and must be set as a boundary condition.  Active boxes keep their
+ *  processes.  Use mapIndices to relate the global indices of the two
+ *  layouts.
+ *  \param[in] a_dbl    Layout providing the boxes and processes
+ *  \param[in] a_localActive
+ *                      Non-zero if a box is active, indexed by the
+ *                      local index of the boxes of a_dbl on this
+ *                      process
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineActive(const DisjointBoxLayout& a_dbl,
+                                const std::vector<int>&  a_localActive)
+{
+  CH_assert((int)a_localActive.size() == a_dbl.localSize());
+  std::vector<int> active(a_dbl.size(), 0);
+#ifdef USE_MPI
+  const int nproc = numProc();
+  if (nproc > 1)
+    {
+      // Boxes on each process are contiguous in the global ordering
+      std::vector<int> counts(nproc, 0);
+      for (int idx = 0; idx != a_dbl.size(); ++idx)
+        {
+          ++counts[a_dbl.getLinear(idx).proc];
+        }
+      std::vector<int> displs(nproc, 0);
+      std::partial_sum(counts.begin(), counts.end() - 1, displs.begin() + 1);
+      MPI_Allgatherv(a_localActive.data(), a_dbl.localSize(), MPI_INT,
+                     active.data(), counts.data(), displs.data(), MPI_INT,
+                     MPI_COMM_WORLD);
+    }
+  else
+#endif
+    {
+      std::copy(a_localActive.begin(), a_localActive.end(),
+                active.begin() + a_dbl.localIdxBegin());
+    }
+
+  std::vector<Box> boxes;
+  std::vector<int> procs;
+  for (int idx = 0; idx != a_dbl.size(); ++idx)
+    {
+      if (active[idx])
+        {
+          const BoxEntry entry = a_dbl.getLinear(idx);
+          boxes.push_back(entry.box);
+          procs.push_back(entry.proc);
+        }
+    }
+  define(a_dbl.m_domain, boxes, procs);
+}
+
+/*--------------------------------------------------------------------*/
+//  Define with deep copy
+/** This routine performs a deep copy, making a completely separate
+ *  array of boxes
+ *  \param[in] a_dbl    DBL to copy
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineDeepCopy(const DisjointBoxLayout& a_dbl)
+{
+  m_domain = a_dbl.m_domain;
+  m_stride = a_dbl.m_stride;
+  m_numBox = a_dbl.m_numBox;
+  m_boxSize = a_dbl.m_boxSize;
+  m_size = a_dbl.m_size;
+  // The bins are copied along with the boxes
+  m_boxes = (a_dbl.m_boxes) ?
+    std::make_shared<BoxList>(*a_dbl.m_boxes) :
+    std::make_shared<BoxList>();
+  m_boxPerProc = a_dbl.m_boxPerProc;
+  m_globalToLattice.reset();
+  m_latticeToGlobal.reset();
+  if (a_dbl.m_globalToLattice)
+    {
+      m_globalToLattice =
+        std::make_shared<std::vector<int>>(*a_dbl.m_globalToLattice);
+      m_latticeToGlobal =
+        std::make_shared<std::vector<int>>(*a_dbl.m_latticeToGlobal);
+    }
+  m_localIdxBeg = a_dbl.m_localIdxBeg;
+  m_numLocalBox = a_dbl.m_numLocalBox;
+}
+
+/*--------------------------------------------------------------------*/
+//  Define the geometry of a lattice of boxes
+/** The boxes themselves and the process assignments are not defined
+ *  \param[in] a_domain The problem domain
+ *  \param[in] a_maxBoxSize
+ *                      Size of each box in each direction.  Must fit
+ *                      evenly.
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineLattice(const Box& a_domain,
+                                 const IntVect& a_maxBoxSize)
 {
   m_domain = a_domain;
-  const IntVect domainSize =
-    a_domain.hiVect() - a_domain.loVect() + IntVect::Unit;
+  m_boxSize = a_maxBoxSize;
+  const IntVect domainSize = a_domain.dimensions();
 
 //--Find the number of boxes in each direction.  They should fit evenly into
 //--the domain.
@@ -112,67 +524,364 @@ DisjointBoxLayout::define(const Box& a_domain, const IntVect& a_maxBoxSize)
          m_stride[1] = m_stride[0]*m_numBox[0];,
          m_stride[2] = m_stride[1]*m_numBox[1];)
     m_size = m_stride[g_SpaceDim-1]*m_numBox[g_SpaceDim-1];
+  m_boxPerProc = 0;
+  m_globalToLattice.reset();
+  m_latticeToGlobal.reset();
+}
 
-  // Allocate the array of boxes
-  m_boxes = std::make_shared<std::vector<BoxEntry>>(m_size);
+/*--------------------------------------------------------------------*/
+//  Use implicit boxes for a lattice
+/** Global and lattice ordering are the same and each process has
+ *  a_boxPerProc contiguous boxes
+ *  \param[in] a_boxPerProc
+ *                      Number of boxes on each process
+ *//*-----------------------------------------------------------------*/
 
-  // Number of boxes per processor
-  const int boxPerProc = m_size/numProc();
-  m_numLocalBox = boxPerProc;
-  m_localIdxBeg = procID()*boxPerProc;
-  // Make sure the boxes fit evenly into the processors
-  CH_assert(m_size == boxPerProc*numProc());
-  
-//--Define the individual boxes and processor assignments for 'm_boxes'
+void
+DisjointBoxLayout::defineImplicit(const int a_boxPerProc)
+{
+  CH_assert(a_boxPerProc > 0 && m_size == a_boxPerProc*numProc());
+  // The array is empty but still provides a unique tag
+  m_boxes = std::make_shared<BoxList>();
+  m_boxPerProc = a_boxPerProc;
+  m_localIdxBeg = procID()*a_boxPerProc;
+  m_numLocalBox = a_boxPerProc;
+}
 
-//**FIXME
-  Box currBox = Box(a_domain.loVect(), a_domain.loVect() + a_maxBoxSize - IntVect::Unit);
-  int linIdxBox = 0; // over all processes
-  
-  for (int procIdx = 0; procIdx != numProc(); ++procIdx)
-  {
-		//for (int boxIdx = 0; boxIdx != m_numBox.product(); ++boxIdx)
-    for (int boxIdx = 0; boxIdx != boxPerProc; ++boxIdx, ++linIdxBox)  
-		{
-			m_boxes->operator[](linIdxBox).proc = procIdx;
-			(m_boxes->operator[](linIdxBox).box).define(currBox.loVect(), currBox.hiVect());
-
-			currBox.shift(a_maxBoxSize[0],0); // Shift in x
-			if (!a_domain.contains(currBox)) // If x-shift put us outside. Reset x. Shift y.
-			{
-				currBox.shift(a_maxBoxSize[1],1);
-				currBox.shift(-a_maxBoxSize[0]*m_numBox[0],0);
-			}
-			if (!a_domain.contains(currBox))
-			{
-				currBox.shift(a_maxBoxSize[2],2);
-				currBox.shift(-a_maxBoxSize[1]*m_numBox[1],1);
-			}
-		}
-  }
-  
+/*--------------------------------------------------------------------*/
+//  Sort the boxes into bins for finding intersections
+/** The bins are a uniform lattice over the domain with the mean box
+ *  size, so each box overlaps only a few bins.  If the boxes sparsely
+ *  cover the domain, the bins are coarsened to limit their number.
+ *  The bins are stored in compressed form: the boxes overlapping bin
+ *  b are binBox[binBeg[b]] to binBox[binBeg[b+1]-1], in increasing
+ *  order of global index.
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::defineBins()
+{
+  CH_assert(m_boxes && (int)m_boxes->entries.size() == m_size);
+  BoxBins& bins = m_boxes->bins;
+  bins = BoxBins();
+  if (m_size == 0) return;
+
+//--Size of the bins
+
+  IntVect sumDim = IntVect::Zero;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      sumDim += getLinear(idx).box.dimensions();
+    }
+  bins.binSize =
+    (sumDim + (m_size - 1)*IntVect::Unit)/(m_size*IntVect::Unit);
+  const IntVect domainDim = m_domain.dimensions();
+  bins.numBin = (domainDim + bins.binSize - IntVect::Unit)/bins.binSize;
+  while (bins.numBin.product() > 8*m_size)
+    {
+      bins.binSize = 2*bins.binSize;
+      bins.numBin = (domainDim + bins.binSize - IntVect::Unit)/bins.binSize;
+    }
+  const IntVect& numBin = bins.numBin;
+
+//--Count the boxes in each bin and then fill
+
+  bins.binBeg.assign(numBin.product() + 1, 0);
+  for (int pass = 0; pass != 2; ++pass)
+    {
+      for (int idx = 0; idx != m_size; ++idx)
+        {
+          const Box& box = getLinear(idx).box;
+          const IntVect lo = (box.loVect() - m_domain.loVect())/bins.binSize;
+          const IntVect hi = (box.hiVect() - m_domain.loVect())/bins.binSize;
+          D_INVTERM(for (int i = lo[0]; i <= hi[0]; ++i),
+                    for (int j = lo[1]; j <= hi[1]; ++j),
+                    for (int k = lo[2]; k <= hi[2]; ++k))
+            {
+              const int idxBin = D_TERM(
+                i, + numBin[0]*j, + numBin[0]*numBin[1]*k);
+              if (pass == 0)
+                {
+                  ++bins.binBeg[idxBin + 1];
+                }
+              else
+                {
+                  bins.binBox[bins.binBeg[idxBin]++] = idx;
+                }
+            }
+        }
+      if (pass == 0)
+        {
+          // Convert counts to begin of each bin
+          std::partial_sum(bins.binBeg.begin(), bins.binBeg.end(),
+                           bins.binBeg.begin());
+          bins.binBox.resize(bins.binBeg.back());
+        }
+      else
+        {
+          // Filling advanced each begin to the next bin.  Shift back.
+          std::copy_backward(bins.binBeg.begin(), bins.binBeg.end() - 1,
+                             bins.binBeg.end());
+          bins.binBeg[0] = 0;
+        }
+    }
 }
 
 /*--------------------------------------------------------------------*/
-//  Define with deep copy
-/** This routine performs a deep copy, making a completely separate
- *  array of boxes
- *  \param[in] a_dbl    DBL to copy
+//  Find all boxes that intersect a region
+/** For lattices, the boxes are found directly from the lattice.
+ *  Otherwise, only boxes in the bins overlapping the region are
+ *  tested.  Either way, the cost is proportional to the number of
+ *  boxes found rather than the number of boxes in the layout.
+ *  \param[in]  a_region
+ *                      Region to intersect
+ *  \param[out] a_globalIdx
+ *                      Global indices of all boxes intersecting the
+ *                      region, in increasing order
  *//*-----------------------------------------------------------------*/
 
 void
-DisjointBoxLayout::defineDeepCopy(const DisjointBoxLayout& a_dbl)
+DisjointBoxLayout::findIntersecting(const Box&        a_region,
+                                    std::vector<int>& a_globalIdx) const
 {
-  m_stride = a_dbl.m_stride;
-  m_numBox = a_dbl.m_numBox;
-  m_size = a_dbl.m_size;
-  m_boxes = std::make_shared<std::vector<BoxEntry> >(m_size);
-  for (int i = 0; i != m_size; ++i)
+  a_globalIdx.clear();
+  Box region(a_region);
+  region &= m_domain;
+  if (region.isEmpty() || m_size == 0) return;
+
+//--Lattice of boxes
+
+  if (isLattice())
+    {
+      const IntVect lo = (region.loVect() - m_domain.loVect())/m_boxSize;
+      const IntVect hi = (region.hiVect() - m_domain.loVect())/m_boxSize;
+      D_INVTERM(for (int i = lo[0]; i <= hi[0]; ++i),
+                for (int j = lo[1]; j <= hi[1]; ++j),
+                for (int k = lo[2]; k <= hi[2]; ++k))
+        {
+          a_globalIdx.push_back(globalIndex(
+            D_TERM(i*m_stride[0], + j*m_stride[1], + k*m_stride[2])));
+        }
+    }
+
+//--Boxes sorted into bins
+
+  else
+    {
+      // Bins are defined with the boxes
+      CH_assert(m_boxes && !m_boxes->bins.binBeg.empty());
+      const BoxBins& bins = m_boxes->bins;
+      const IntVect lo = (region.loVect() - m_domain.loVect())/bins.binSize;
+      const IntVect hi = (region.hiVect() - m_domain.loVect())/bins.binSize;
+      D_INVTERM(for (int i = lo[0]; i <= hi[0]; ++i),
+                for (int j = lo[1]; j <= hi[1]; ++j),
+                for (int k = lo[2]; k <= hi[2]; ++k))
+        {
+          const IntVect ivBin(D_DECL(i, j, k));
+          const int idxBin = D_TERM(
+            i, + bins.numBin[0]*j, + bins.numBin[0]*bins.numBin[1]*k);
+          for (int c = bins.binBeg[idxBin], c_end = bins.binBeg[idxBin + 1];
+               c != c_end; ++c)
+            {
+              const int idx = bins.binBox[c];
+              Box test = getLinear(idx).box;
+              test &= region;
+              // A box may overlap several bins.  Only report it from the bin
+              // containing the lower corner of the intersection.
+              if (!test.isEmpty() &&
+                  (test.loVect() - m_domain.loVect())/bins.binSize == ivBin)
+                {
+                  a_globalIdx.push_back(idx);
+                }
+            }
+        }
+    }
+  std::sort(a_globalIdx.begin(), a_globalIdx.end());
+}
+
+/*--------------------------------------------------------------------*/
+//  Write the layout to a binary stream
+/** The layout can be restored with readBinary by a run with the same
+ *  number of processes, skipping the define (e.g., on restart).  All
+ *  processes hold the entire layout so any process may write it.
+ *  Implicit layouts are written without boxes.  The format is not
+ *  portable between machines.
+ *  \param[in]  a_os    Binary output stream
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::writeBinary(std::ostream& a_os) const
+{
+  static_assert(std::is_trivially_copyable<BoxEntry>::value,
+                "BoxEntry must be trivially copyable");
+  const int numEntry = (m_boxes) ? m_boxes->entries.size() : 0;
+  const int header[] = {
+    s_binaryMagic,
+    g_SpaceDim,
+    numProc(),
+    m_size,
+    m_boxPerProc,
+    numEntry,
+    (m_globalToLattice) ? 1 : 0
+  };
+  a_os.write(reinterpret_cast<const char*>(header), sizeof(header));
+  a_os.write(reinterpret_cast<const char*>(&m_domain), sizeof(Box));
+  a_os.write(reinterpret_cast<const char*>(&m_boxSize), sizeof(IntVect));
+  if (numEntry > 0)
+    {
+      a_os.write(reinterpret_cast<const char*>(m_boxes->entries.data()),
+                 numEntry*sizeof(BoxEntry));
+    }
+  if (m_globalToLattice)
     {
-      getLinear(i) = a_dbl.getLinear(i);
+      a_os.write(reinterpret_cast<const char*>(m_globalToLattice->data()),
+                 m_size*sizeof(int));
     }
 }
 
+/*--------------------------------------------------------------------*/
+//  Read a layout written by writeBinary
+/** The layout is keyed by the domain, the box size, and the number of
+ *  processes.  If these do not match (or the stream cannot be read),
+ *  the layout should be defined normally.
+ *  \param[in]  a_is    Binary input stream
+ *  \param[in]  a_domain
+ *                      Expected problem domain
+ *  \param[in]  a_maxBoxSize
+ *                      Expected size of the boxes in a lattice.  Use
+ *                      IntVect::Zero for a layout from a list of
+ *                      boxes.
+ *  \return             0 - success
+ *                      1 - the stream does not contain a layout
+ *                      2 - the layout has a different domain, box
+ *                          size, or number of processes
+ *//*-----------------------------------------------------------------*/
+
+int
+DisjointBoxLayout::readBinary(std::istream&  a_is,
+                              const Box&     a_domain,
+                              const IntVect& a_maxBoxSize)
+{
+  int header[7];
+  Box domain;
+  IntVect boxSize;
+  a_is.read(reinterpret_cast<char*>(header), sizeof(header));
+  a_is.read(reinterpret_cast<char*>(&domain), sizeof(Box));
+  a_is.read(reinterpret_cast<char*>(&boxSize), sizeof(IntVect));
+  if (!a_is || header[0] != s_binaryMagic || header[1] != g_SpaceDim)
+    {
+      return 1;
+    }
+  if (header[2] != numProc() || domain != a_domain || boxSize != a_maxBoxSize)
+    {
+      return 2;
+    }
+  const int size       = header[3];
+  const int boxPerProc = header[4];
+  const int numEntry   = header[5];
+  const bool hasMaps   = (header[6] != 0);
+
+  if (boxSize != IntVect::Zero)
+    {
+      defineLattice(domain, boxSize);
+      CH_assert(m_size == size);
+      if (boxPerProc > 0)
+        {
+          defineImplicit(boxPerProc);
+          return 0;
+        }
+    }
+  else
+    {
+      m_domain = domain;
+      m_stride = IntVect::Zero;
+      m_numBox = IntVect::Zero;
+      m_boxSize = IntVect::Zero;
+      m_size = size;
+      m_boxPerProc = 0;
+      m_globalToLattice.reset();
+      m_latticeToGlobal.reset();
+    }
+
+  CH_assert(numEntry == m_size);
+  m_boxes = std::make_shared<BoxList>();
+  m_boxes->entries.resize(numEntry);
+  a_is.read(reinterpret_cast<char*>(m_boxes->entries.data()),
+            numEntry*sizeof(BoxEntry));
+  if (hasMaps)
+    {
+      m_globalToLattice = std::make_shared<std::vector<int>>(m_size);
+      m_latticeToGlobal = std::make_shared<std::vector<int>>(m_size);
+      a_is.read(reinterpret_cast<char*>(m_globalToLattice->data()),
+                m_size*sizeof(int));
+      for (int idx = 0; idx != m_size; ++idx)
+        {
+          (*m_latticeToGlobal)[(*m_globalToLattice)[idx]] = idx;
+        }
+    }
+  if (!a_is)
+    {
+      return 1;
+    }
+
+  // Boxes are ordered by process
+  m_localIdxBeg = 0;
+  m_numLocalBox = 0;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      if (m_boxes->entries[idx].proc == procID())
+        {
+          if (m_numLocalBox == 0)
+            {
+              m_localIdxBeg = idx;
+            }
+          ++m_numLocalBox;
+        }
+    }
+  if (!isLattice())
+    {
+      defineBins();
+    }
+  return 0;
+}
+
+/*--------------------------------------------------------------------*/
+//  Map global indices of boxes in this layout to those in another
+/** The boxes may be ordered differently, e.g., because of different
+ *  process assignments.  a_dbl may also contain more boxes than this
+ *  layout, e.g., if this layout only has the active boxes of a_dbl
+ *  (see defineActive).
+ *  \param[in]  a_dbl   Other layout
+ *  \param[out] a_map   For each global index in this layout, the
+ *                      global index of the same box in a_dbl (-1 if
+ *                      not found)
+ *  \return             0  Success
+ *                      >0 Number of boxes that could not be matched
+ *//*-----------------------------------------------------------------*/
+
+int
+DisjointBoxLayout::mapIndices(const DisjointBoxLayout& a_dbl,
+                              std::vector<int>&        a_map) const
+{
+  a_map.assign(m_size, -1);
+  int numUnmatched = 0;
+  std::vector<int> found;
+  for (int idx = 0; idx != m_size; ++idx)
+    {
+      const Box& box = getLinear(idx).box;
+      a_dbl.findIntersecting(box, found);
+      if (found.size() == 1 && a_dbl.getLinear(found[0]).box == box)
+        {
+          a_map[idx] = found[0];
+        }
+      else
+        {
+          ++numUnmatched;
+        }
+    }
+  return numUnmatched;
+}
+
 #ifndef NO_CGNS
 /*--------------------------------------------------------------------*/
 //  Write CGNS zone and grid to a file
@@ -304,7 +1013,7 @@ DisjointBoxLayout::writeCGNSZoneGrid(const int      a_indexFile,
       box.growHi(1);  // Since we need vertices
       const IntVect loV = box.loVect();
       const IntVect hiV = box.hiVect();
-      BaseFab<Real> coords(box, 1);
+      FABSTACKTEMP(coords, box, 1);
 #ifdef USE_MPI
       const int localBoxIndex = (*dit).localIndex();
       CGNSIndices& thisCGNSIndices = localCGNSIndices[localBoxIndex];
@@ -371,6 +1080,55 @@ DisjointBoxLayout::writeCGNSZoneGrid(const int      a_indexFile,
 }
 #endif  /* CGNS */
 
+/*--------------------------------------------------------------------*/
+//  Statistics on the distribution of boxes among nodes
+/** Faces are counted between boxes that are adjacent across a face
+ *  (not an edge or corner).  Periodic boundaries are not considered.
+ *  The statistics are computed from the global layout and require no
+ *  communication.
+ *  \param[out] a_stats Statistics
+ *//*-----------------------------------------------------------------*/
+
+void
+DisjointBoxLayout::statistics(Statistics& a_stats) const
+{
+  a_stats.numBoxNode.assign(numNode(), 0);
+  a_stats.numCellNode.assign(numNode(), 0);
+  a_stats.numFaceCellProc = 0;
+  a_stats.numFaceCellNode = 0;
+  a_stats.numFaceCellInterNode = 0;
+  for (LayoutIterator lit(*this); lit.ok(); ++lit)
+    {
+      const BoxEntry entry = getLinear((*lit).globalIndex());
+      const int node = s_procNode[entry.proc];
+      ++a_stats.numBoxNode[node];
+      a_stats.numCellNode[node] += entry.box.size();
+      for (NeighborIterator nbrit(lit, TrimEdge | TrimCorner); nbrit.ok();
+           ++nbrit)
+        {
+          // Count each pair of boxes once
+          if ((*nbrit).globalIndex() < (*lit).globalIndex()) continue;
+          const BoxEntry nbrEntry = getLinear((*nbrit).globalIndex());
+          Box face(entry.box);
+          face.shift(nbrit.nbrDir());
+          face &= nbrEntry.box;
+          if (face.isEmpty() || nbrit.nbrDir().norm1() != 1) continue;
+          if (nbrEntry.proc == entry.proc)
+            {
+              a_stats.numFaceCellProc += face.size();
+            }
+          else if (s_procNode[nbrEntry.proc] == node)
+            {
+              a_stats.numFaceCellNode += face.size();
+            }
+          else
+            {
+              a_stats.numFaceCellInterNode += face.size();
+            }
+        }
+    }
+}
+
 /*--------------------------------------------------------------------*/
 //  Initialize MPI
 /** Any application or test using MPI must call this routine first
@@ -383,6 +1141,31 @@ DisjointBoxLayout::initMPI(int argc, const char* argv[])
   MPI_Init(&argc, const_cast<char***>(&argv));
   MPI_Comm_size(MPI_COMM_WORLD, &s_numProc);
   MPI_Comm_rank(MPI_COMM_WORLD, &s_procID);
+
+  // Find the processes sharing each node.  Each node is identified by its
+  // lowest process.
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, s_procID,
+                      MPI_INFO_NULL, &nodeComm);
+  int nodeLeader = s_procID;
+  MPI_Bcast(&nodeLeader, 1, MPI_INT, 0, nodeComm);
+  MPI_Comm_free(&nodeComm);
+  std::vector<int> procLeader(s_numProc);
+  MPI_Allgather(&nodeLeader, 1, MPI_INT, procLeader.data(), 1, MPI_INT,
+                MPI_COMM_WORLD);
+  s_procNode.assign(s_numProc, 0);
+  s_numNode = 0;
+  for (int iProc = 0; iProc != s_numProc; ++iProc)
+    {
+      if (procLeader[iProc] == iProc)
+        {
+          s_procNode[iProc] = s_numNode++;
+        }
+      else
+        {
+          s_procNode[iProc] = s_procNode[procLeader[iProc]];
+        }
+    }
 #ifndef NO_CGNS
   cgp_mpi_comm(MPI_COMM_WORLD);
 #endif
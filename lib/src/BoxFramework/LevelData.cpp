@@ -8,6 +8,7 @@
  *//*+*************************************************************************/
 
 #include <vector>
+#include <type_traits>
 
 #ifndef NO_CGNS
 #ifdef USE_MPI
@@ -19,6 +20,8 @@
 
 #include "LevelData.H"
 #include "BaseFab.H"
+#include "BaseFabExpr.H"
+#include "ScratchArena.H"
 
 
 /*******************************************************************************
@@ -28,9 +31,25 @@
  ******************************************************************************/
 
 #ifndef NO_CGNS
+// Local storage of indices for a Box
+namespace{
+struct CGNSIndices
+{
+  CGNSIndices()
+    {
+      indexField.reserve(2 + g_SpaceDim);  // Reserve estimate of space
+    }
+  int indexSol;
+  std::vector<int> indexField;
+};
+
 /*--------------------------------------------------------------------*/
-//  Write CGNS solution data to a file (specialized for BaseFab<Real>)
-/** The CGNS file must be open
+//  Write CGNS solution data to a file
+/** The CGNS file must be open.  Data is always written as Real.
+ *  Reduced-precision storage is first widened into a scratch buffer
+ *  holding the core grid of one component.
+ *  \tparam    S        Storage type of the BaseFabs
+ *  \param[in] a_data   LevelData to write
  *  \param[in] a_indexFile
  *                      CGNS index of file
  *  \param[in] a_indexBase
@@ -49,29 +68,20 @@
  *  </ul>
  *//*-----------------------------------------------------------------*/
 
-// Local storage of indices for a Box
-namespace{
-struct CGNSIndices
-{
-  CGNSIndices()
-    {
-      indexField.reserve(2 + g_SpaceDim);  // Reserve estimate of space
-    }
-  int indexSol;
-  std::vector<int> indexField;
-};
-}
-
-template<>
+template <typename S>
 int
-LevelData<BaseFab<Real> >::writeCGNSSolData(
-  const int                a_indexFile,
-  const int                a_indexBase,
-  const int                a_indexZoneOffset,
-  const char *const *const a_varNames) const
+writeSolData(const LevelData<BaseFab<S> >& a_data,
+             const int                     a_indexFile,
+             const int                     a_indexBase,
+             const int                     a_indexZoneOffset,
+             const char *const *const      a_varNames)
 {
+  const DisjointBoxLayout& dbl = a_data.disjointBoxLayout();
+  const int ncomp = a_data.ncomp();
+  const int nghost = a_data.nghost();
+  constexpr bool widen = !std::is_same<S, Real>::value;
   int cgerr;
-  std::vector<CGNSIndices> localCGNSIndices(m_disjointBoxLayout.localSize());
+  std::vector<CGNSIndices> localCGNSIndices(dbl.localSize());
 
 //--These variables describe the shape of the array in the CGNS file.  We only
 //--want to write the core grid.  The min corner of the core grid has index
@@ -93,8 +103,8 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
  * same information and note use of LayoutIterator
  *- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  std::vector<int> indexField(ncomp());
-  for (LayoutIterator lit(m_disjointBoxLayout); lit.ok(); ++lit)
+  std::vector<int> indexField(ncomp);
+  for (LayoutIterator lit(dbl); lit.ok(); ++lit)
     {
       const int globalBoxIndex = (*lit).globalIndex();
       const int localBoxIndex  = (*lit).localIndex();
@@ -112,7 +122,7 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
       // Write the meta-data to a field solution node for each component
       // (user must use SIDS-standard names here)
 #ifdef USE_MPI
-      for (int iComp = 0; iComp != ncomp(); ++iComp)
+      for (int iComp = 0; iComp != ncomp; ++iComp)
         {
           cgp_field_write(a_indexFile,
                           a_indexBase,
@@ -124,12 +134,12 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
           if (cgerr) return indexZone;
         }
 #endif
-      if (DisjointBoxLayout::procID() == m_disjointBoxLayout.proc(lit))
+      if (DisjointBoxLayout::procID() == dbl.proc(lit))
         {
           CGNSIndices& thisCGNSIndices = localCGNSIndices[localBoxIndex];
           thisCGNSIndices.indexSol = indexSol;
 #ifdef USE_MPI
-          for (int iComp = 0; iComp != ncomp(); ++iComp)
+          for (int iComp = 0; iComp != ncomp; ++iComp)
             {
               thisCGNSIndices.indexField.push_back(indexField[iComp]);
             }
@@ -142,7 +152,7 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
  * its own information (note use of DataIterator)
  *- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  for (DataIterator dit(m_disjointBoxLayout); dit.ok(); ++dit)
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
     {
       const int globalBoxIndex = (*dit).globalIndex();
       const int localBoxIndex  = (*dit).localIndex();
@@ -150,21 +160,34 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
       CGNSIndices& thisCGNSIndices = localCGNSIndices[localBoxIndex];
       // Only write the core grid (not ghost cells).  Indexing in CGNS starts
       // at 1, not 0.
-      const IntVect boxdim = m_disjointBoxLayout[dit].dimensions();
-      const BaseFab<Real>& fab = this->operator[](dit);
-      const IntVect fabdim = fab.box().dimensions();
+      const Box box = dbl[dit];
+      const IntVect boxdim = box.dimensions();
+      const BaseFab<S>& fab = a_data[dit];
+      // Array dimensions include any padding of the strides
+      const IntVect fabdim = fab.getArrayDims();
       for (int dir = 0; dir != g_SpaceDim; ++dir)
         {
           // The range of the data in the CGNS file (only contains core grid)
           rmin[dir]    = 1;
           rmax[dir]    = boxdim[dir];
-          // The size and range of data in memory
-          memdim[dir]  = fabdim[dir];
-          memrmin[dir] = 1 + m_nghost;
-          memrmax[dir] = memdim[dir] - m_nghost;
+          // The size and range of data in memory (the widened buffer only
+          // has the core grid)
+          memdim[dir]  = (widen) ? boxdim[dir] : fabdim[dir];
+          memrmin[dir] = 1 + ((widen) ? 0 : nghost);
+          memrmax[dir] = ((widen) ? 0 : nghost) + boxdim[dir];
         }
-      for (int iComp = 0; iComp != ncomp(); ++iComp)
+      ScratchArena::Scope scope;
+      Real *const widened = (widen) ?
+        scope.allocate<Real>(FArrayBox::aliasSize(box, 1)) : nullptr;
+      for (int iComp = 0; iComp != ncomp; ++iComp)
         {
+          const void* data = fab.dataPtr(iComp);
+          if (widen)
+            {
+              FArrayBox widenedFab(box, 1, widened);
+              FabExpr::assign(widenedFab, box, 0, FabExpr::term(fab, iComp));
+              data = widened;
+            }
 #if USE_MPI
           cgerr = cgp_field_general_write_data(
             a_indexFile,
@@ -174,7 +197,7 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
             thisCGNSIndices.indexField[iComp],
             rmin, rmax,
             memnumdim, memdim, memrmin, memrmax,
-            fab.dataPtr(iComp));
+            data);
 #else
           cgerr = cg_field_general_write(
             a_indexFile,
@@ -185,7 +208,7 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
             a_varNames[iComp],
             rmin, rmax,
             memnumdim, memdim, memrmin, memrmax,
-            fab.dataPtr(iComp),
+            data,
             &indexField[iComp]);
 #endif
           if (cgerr) return indexZone;
@@ -194,4 +217,58 @@ LevelData<BaseFab<Real> >::writeCGNSSolData(
 
   return 0;
 }
+}  // anonymous namespace
+
+/*--------------------------------------------------------------------*/
+//  Write CGNS solution data to a file (specialized for BaseFab<Real>)
+/** See writeSolData above
+ *//*-----------------------------------------------------------------*/
+
+template<>
+int
+LevelData<BaseFab<Real> >::writeCGNSSolData(
+  const int                a_indexFile,
+  const int                a_indexBase,
+  const int                a_indexZoneOffset,
+  const char *const *const a_varNames) const
+{
+  return writeSolData(*this, a_indexFile, a_indexBase, a_indexZoneOffset,
+                      a_varNames);
+}
+
+#ifndef USE_SINGLE_PRECISION
+/*--------------------------------------------------------------------*/
+//  Write CGNS solution data to a file (specialized for BaseFab<float>)
+/** Data is widened to Real (see writeSolData above)
+ *//*-----------------------------------------------------------------*/
+
+template<>
+int
+LevelData<BaseFab<float> >::writeCGNSSolData(
+  const int                a_indexFile,
+  const int                a_indexBase,
+  const int                a_indexZoneOffset,
+  const char *const *const a_varNames) const
+{
+  return writeSolData(*this, a_indexFile, a_indexBase, a_indexZoneOffset,
+                      a_varNames);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+//  Write CGNS solution data to a file (specialized for BaseFab<BFloat16>)
+/** Data is widened to Real (see writeSolData above)
+ *//*-----------------------------------------------------------------*/
+
+template<>
+int
+LevelData<BaseFab<BFloat16> >::writeCGNSSolData(
+  const int                a_indexFile,
+  const int                a_indexBase,
+  const int                a_indexZoneOffset,
+  const char *const *const a_varNames) const
+{
+  return writeSolData(*this, a_indexFile, a_indexBase, a_indexZoneOffset,
+                      a_varNames);
+}
 #endif  /* CGNS */
@@ -14,13 +14,111 @@
 // Feature Test Macro for nanosleep
 #define _POSIX_C_SOURCE 199309L
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <time.h>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <atomic>
+#include <string>
 
 #include "LinuxSupport.H"
 
+namespace
+{
+
+/// Size of a huge page (the usual 2 MiB)
+constexpr size_t c_hugePageSize = 2*1024*1024;
+
+/// Allocations of at least this size use huge pages (0 never)
+std::atomic<size_t> s_hugePageThreshold(c_hugePageSize);
+
+/// Counters for System::hugePageCounters
+std::atomic<size_t> s_bytesHugetlb(0);
+std::atomic<size_t> s_bytesAdvised(0);
+std::atomic<size_t> s_bytesFallback(0);
+std::atomic<size_t> s_bytesSmall(0);
+
+/// Directory of files backing memory from memalignFile (empty for the
+/// default)
+std::string s_scratchDir;
+
+/// Stored just before memory returned by memalignLarge or memalignFile
+struct LargeHeader
+{
+  void* base;                         ///< Start of the allocation
+  size_t mapSize;                     ///< Bytes mapped (0 if from
+                                      ///< posix_memalign)
+};
+
+/// Map anonymous memory, aligned to huge pages if possible
+void* mapHuge(const size_t a_size, size_t& a_mapSize)
+{
+  a_mapSize = ((a_size + c_hugePageSize - 1)/c_hugePageSize)*c_hugePageSize;
+#ifdef MAP_HUGETLB
+  // Explicit huge pages if any are reserved
+  void *const hugetlb = mmap(nullptr, a_mapSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (hugetlb != MAP_FAILED)
+    {
+      s_bytesHugetlb += a_mapSize;
+      return hugetlb;
+    }
+#endif
+  // Otherwise, map an extra huge page and trim so the start is aligned
+  const size_t overSize = a_mapSize + c_hugePageSize;
+  void* over = mmap(nullptr, overSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (over == MAP_FAILED)
+    {
+      return nullptr;
+    }
+  const uintptr_t overBegin = reinterpret_cast<uintptr_t>(over);
+  const uintptr_t begin = ((overBegin + c_hugePageSize - 1)/c_hugePageSize)*
+    c_hugePageSize;
+  if (begin > overBegin)
+    {
+      munmap(over, begin - overBegin);
+    }
+  const size_t tail = overBegin + overSize - (begin + a_mapSize);
+  if (tail > 0)
+    {
+      munmap(reinterpret_cast<void*>(begin + a_mapSize), tail);
+    }
+  void *const addr = reinterpret_cast<void*>(begin);
+#ifdef MADV_HUGEPAGE
+  if (madvise(addr, a_mapSize, MADV_HUGEPAGE) == 0)
+    {
+      s_bytesAdvised += a_mapSize;
+      return addr;
+    }
+#endif
+  s_bytesFallback += a_mapSize;
+  return addr;
+}
+
+/// Expand a range of memory to whole pages
+void pageRange(const void *const a_addr,
+               const size_t      a_size,
+               void*&            a_begin,
+               size_t&           a_length)
+{
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(a_addr);
+  const uintptr_t begin = addr & ~(pageSize - 1);
+  const uintptr_t end = (addr + a_size + pageSize - 1) & ~(pageSize - 1);
+  a_begin = reinterpret_cast<void*>(begin);
+  a_length = end - begin;
+}
+
+}  // anonymous namespace
+
 
 /*============================================================================*/
 //  Get the path and name of the currently running executable
@@ -112,3 +210,374 @@ int System::sleep(const double s)
   req.tv_nsec = static_cast<long>((std::fabs(s) - sec)*1.E9);
   return nanosleep(&req, &rem);
 }
+
+
+/*============================================================================*/
+//  Count the pages of a memory range on each NUMA node
+/**
+ *  Queries the node of each page with move_pages(2) (without moving
+ *  anything).  Pages are placed on a node when first touched so this
+ *  shows whether first touch by threads worked.
+ *  \param[in]  a_addr  Start of the memory range
+ *  \param[in]  a_size  Number of bytes in the range
+ *  \param[in]  a_numPageNode
+ *                      Number of pages previously counted on each node
+ *  \param[out] a_numPageNode
+ *                      Pages of the range are added to the count of
+ *                      their node.  Resized as required.
+ *  \return             >= 0 - Number of pages not yet touched (not
+ *                             counted on any node)
+ *                      -1   - Unable to query the nodes
+ *//*=========================================================================*/
+
+int System::pageNodes(const void *const a_addr,
+                      const size_t      a_size,
+                      std::vector<int>& a_numPageNode)
+{
+#ifdef SYS_move_pages
+  if (a_size == 0) return 0;
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(a_addr);
+  const uintptr_t begin = addr & ~(pageSize - 1);
+  const uintptr_t end = addr + a_size;
+  const size_t numPage = (end - begin + pageSize - 1)/pageSize;
+  std::vector<void*> pages(numPage);
+  for (size_t i = 0; i != numPage; ++i)
+    {
+      pages[i] = reinterpret_cast<void*>(begin + i*pageSize);
+    }
+  std::vector<int> nodes(numPage, -1);
+  // With no target nodes, the node of each page is returned in nodes
+  if (syscall(SYS_move_pages, 0, numPage, pages.data(), nullptr,
+              nodes.data(), 0) != 0)
+    {
+      return -1;
+    }
+  int numUntouched = 0;
+  for (const int node : nodes)
+    {
+      if (node < 0)
+        {
+          ++numUntouched;
+          continue;
+        }
+      if (node >= (int)a_numPageNode.size())
+        {
+          a_numPageNode.resize(node + 1, 0);
+        }
+      ++a_numPageNode[node];
+    }
+  return numUntouched;
+#else
+  (void)a_addr;
+  (void)a_size;
+  (void)a_numPageNode;
+  return -1;
+#endif
+}
+
+
+/*============================================================================*/
+//  Allocate aligned memory, on huge pages if at least a threshold size
+/**
+ *  Allocations of at least hugePageThreshold() bytes are mapped with
+ *  mmap, from explicit huge pages (hugetlbfs) if any are reserved, or
+ *  else with madvise(MADV_HUGEPAGE) so the kernel backs them with
+ *  transparent huge pages.  Smaller allocations, and large ones if
+ *  mmap fails, use posix_memalign.  Streaming through large arrays, or
+ *  many component planes of one array, then needs far fewer TLB
+ *  entries.
+ *  \param[out] a_memptr
+ *                      Pointer to allocated memory
+ *  \param[in]  a_alignment
+ *                      Alignment in bytes.  Must be a multiple of
+ *                      sizeof(void*), a power of 2, and no more than
+ *                      the page size.
+ *  \param[in]  a_size  Number of bytes to allocate
+ *  \return             0       - Success
+ *                      <posix_memalign>
+ *  \note
+ *  <ul>
+ *    <li> Memory allocated with memalignLarge must be deallocated with
+ *         freeLarge()
+ *  </ul>
+ *//*=========================================================================*/
+
+int System::memalignLarge(void **a_memptr, size_t a_alignment, size_t a_size)
+{
+  // The header is placed in front of the aligned memory
+  const size_t headerSize =
+    ((sizeof(LargeHeader) + a_alignment - 1)/a_alignment)*a_alignment;
+  const size_t threshold = s_hugePageThreshold;
+  if (threshold > 0 && a_size >= threshold)
+    {
+      size_t mapSize = 0;
+      char *const base =
+        static_cast<char*>(mapHuge(a_size + headerSize, mapSize));
+      if (base != nullptr)
+        {
+          LargeHeader *const header =
+            reinterpret_cast<LargeHeader*>(base + headerSize) - 1;
+          header->base = base;
+          header->mapSize = mapSize;
+          *a_memptr = base + headerSize;
+          return 0;
+        }
+      s_bytesFallback += a_size;
+    }
+  else
+    {
+      s_bytesSmall += a_size;
+    }
+  void* base = nullptr;
+  const int err = posix_memalign(&base, a_alignment, a_size + headerSize);
+  if (err)
+    {
+      return err;
+    }
+  LargeHeader *const header = reinterpret_cast<LargeHeader*>(
+    static_cast<char*>(base) + headerSize) - 1;
+  header->base = base;
+  header->mapSize = 0;
+  *a_memptr = static_cast<char*>(base) + headerSize;
+  return 0;
+}
+
+
+/*============================================================================*/
+//  Free memory allocated by memalignLarge
+/**
+ *  \param[in]  a_mem   Memory from memalignLarge (nullptr is ignored)
+ *//*=========================================================================*/
+
+void System::freeLarge(void *const a_mem)
+{
+  if (a_mem == nullptr) return;
+  const LargeHeader *const header = static_cast<LargeHeader*>(a_mem) - 1;
+  if (header->mapSize > 0)
+    {
+      munmap(header->base, header->mapSize);
+    }
+  else
+    {
+      free(header->base);
+    }
+}
+
+
+/*============================================================================*/
+//  Set the size at which memalignLarge uses huge pages
+/**
+ *  \param[in]  a_size  Minimum size in bytes (default 2 MiB).  0
+ *                      disables huge pages.
+ *//*=========================================================================*/
+
+void System::setHugePageThreshold(const size_t a_size)
+{
+  s_hugePageThreshold = a_size;
+}
+
+
+/*============================================================================*/
+//  Size at which memalignLarge uses huge pages
+/**
+ *  \return             Minimum size in bytes (0 if disabled)
+ *//*=========================================================================*/
+
+size_t System::hugePageThreshold()
+{
+  return s_hugePageThreshold;
+}
+
+
+/*============================================================================*/
+//  Total bytes allocated by memalignLarge
+/**
+ *  Mapped sizes are rounded up to whole huge pages.  Bytes requested as
+ *  transparent huge pages are only backed by them if the kernel finds
+ *  huge pages when the memory is first touched (see
+ *  anonHugePageBytes()).
+ *  \return             Counters since the start of the process
+ *//*=========================================================================*/
+
+System::HugePageCounters System::hugePageCounters()
+{
+  HugePageCounters counters;
+  counters.bytesHugetlb = s_bytesHugetlb;
+  counters.bytesAdvised = s_bytesAdvised;
+  counters.bytesFallback = s_bytesFallback;
+  counters.bytesSmall = s_bytesSmall;
+  return counters;
+}
+
+
+/*============================================================================*/
+//  Bytes of this process on transparent huge pages
+/**
+ *  \return             >= 0 - AnonHugePages from /proc/self/smaps_rollup
+ *                      -1   - Not available
+ *//*=========================================================================*/
+
+long System::anonHugePageBytes()
+{
+  FILE *const file = fopen("/proc/self/smaps_rollup", "r");
+  if (file == nullptr) return -1;
+  long kiB = -1;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != nullptr)
+    {
+      if (sscanf(line, "AnonHugePages: %ld kB", &kiB) == 1)
+        {
+          break;
+        }
+    }
+  fclose(file);
+  return (kiB < 0) ? -1 : 1024*kiB;
+}
+
+
+/*============================================================================*/
+//  Set the directory of files backing memory from memalignFile
+/**
+ *  The directory should be on fast local scratch (e.g., an NVMe drive)
+ *  rather than a network file system.
+ *  \param[in]  a_dir   Directory.  nullptr or "" restores the default
+ *                      ($TMPDIR, or else /tmp).
+ *//*=========================================================================*/
+
+void System::setScratchDir(const char *const a_dir)
+{
+  s_scratchDir = (a_dir == nullptr) ? "" : a_dir;
+}
+
+
+/*============================================================================*/
+//  Directory of files backing memory from memalignFile
+/**
+ *  \return             The directory set by setScratchDir, or else
+ *                      $TMPDIR, or else /tmp
+ *//*=========================================================================*/
+
+const char* System::scratchDir()
+{
+  if (!s_scratchDir.empty())
+    {
+      return s_scratchDir.c_str();
+    }
+  const char *const tmpDir = getenv("TMPDIR");
+  return (tmpDir != nullptr && tmpDir[0] != '\0') ? tmpDir : "/tmp";
+}
+
+
+/*============================================================================*/
+//  Allocate aligned memory mapped from a temporary file
+/**
+ *  A file is created in scratchDir() and unlinked immediately, so it
+ *  is removed when the memory is freed or the process ends.  The
+ *  memory is a shared mapping of the file, so the kernel writes pages
+ *  back to the file and drops them from memory as required.  The
+ *  allocation can therefore be larger than physical memory but is
+ *  only fast if accessed in a predictable order (see adviseWillNeed
+ *  and adviseDontNeed).  The memory is initially zero.
+ *  \param[out] a_memptr
+ *                      Pointer to allocated memory
+ *  \param[in]  a_alignment
+ *                      Alignment in bytes.  Must be a multiple of
+ *                      sizeof(void*), a power of 2, and no more than
+ *                      the page size.
+ *  \param[in]  a_size  Number of bytes to allocate
+ *  \return             0       - Success
+ *                      errno from creating, sizing, or mapping the
+ *                      file
+ *  \note
+ *  <ul>
+ *    <li> Memory allocated with memalignFile must be deallocated with
+ *         freeLarge()
+ *  </ul>
+ *//*=========================================================================*/
+
+int System::memalignFile(void **a_memptr, size_t a_alignment, size_t a_size)
+{
+  const size_t headerSize =
+    ((sizeof(LargeHeader) + a_alignment - 1)/a_alignment)*a_alignment;
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  const size_t mapSize =
+    ((a_size + headerSize + pageSize - 1)/pageSize)*pageSize;
+  std::string path(scratchDir());
+  path += "/BoxFrameworkXXXXXX";
+  const int fd = mkstemp(&path[0]);
+  if (fd < 0)
+    {
+      return errno;
+    }
+  unlink(path.c_str());
+  if (ftruncate(fd, mapSize) != 0)
+    {
+      const int err = errno;
+      close(fd);
+      return err;
+    }
+  void *const base = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0);
+  const int err = errno;
+  // The mapping keeps the file open
+  close(fd);
+  if (base == MAP_FAILED)
+    {
+      return err;
+    }
+  LargeHeader *const header = reinterpret_cast<LargeHeader*>(
+    static_cast<char*>(base) + headerSize) - 1;
+  header->base = base;
+  header->mapSize = mapSize;
+  *a_memptr = static_cast<char*>(base) + headerSize;
+  return 0;
+}
+
+
+/*============================================================================*/
+//  Advise that a memory range will be needed soon (start reading it in)
+/**
+ *  For memory from memalignFile, pages not in memory are read from the
+ *  file in the background.  The range is expanded to whole pages.
+ *  \param[in]  a_addr  Start of the memory range
+ *  \param[in]  a_size  Number of bytes in the range
+ *  \return             0 - Success
+ *                      errno from madvise
+ *//*=========================================================================*/
+
+int System::adviseWillNeed(const void *const a_addr, const size_t a_size)
+{
+  if (a_size == 0) return 0;
+  void* begin;
+  size_t length;
+  pageRange(a_addr, a_size, begin, length);
+  return (madvise(begin, length, MADV_WILLNEED) == 0) ? 0 : errno;
+}
+
+
+/*============================================================================*/
+//  Advise that a range of memory from memalignFile is not needed soon
+/**
+ *  The pages are unmapped from the process but the data is kept in the
+ *  file (and the page cache until the kernel needs the memory).  The
+ *  next access reads them back.  The range is expanded to whole pages.
+ *  \param[in]  a_addr  Start of the memory range
+ *  \param[in]  a_size  Number of bytes in the range
+ *  \return             0 - Success
+ *                      errno from madvise
+ *  \note
+ *  <ul>
+ *    <li> Only use this with memory from memalignFile.  Other (private)
+ *         memory would be zeroed.
+ *  </ul>
+ *//*=========================================================================*/
+
+int System::adviseDontNeed(const void *const a_addr, const size_t a_size)
+{
+  if (a_size == 0) return 0;
+  void* begin;
+  size_t length;
+  pageRange(a_addr, a_size, begin, length);
+  return (madvise(begin, length, MADV_DONTNEED) == 0) ? 0 : errno;
+}
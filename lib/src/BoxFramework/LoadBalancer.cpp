@@ -0,0 +1,465 @@
+
+/******************************************************************************/
+/**
+ * \file LoadBalancer.cpp
+ *
+ * \brief Non-inline definitions for classes in LoadBalancer.H
+ *
+ *//*+*************************************************************************/
+
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "LoadBalancer.H"
+
+
+/*******************************************************************************
+ *
+ * Class LoadBalancer: member definitions
+ *
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------*/
+//  Default constructor
+/*--------------------------------------------------------------------*/
+
+LoadBalancer::LoadBalancer()
+  :
+  m_disjointBoxLayout(),
+  m_timer(),
+  m_cost(),
+  m_migrate(),
+  m_copier()
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor
+/** \param[in]  a_dbl   Initial layout of boxes
+ *//*-----------------------------------------------------------------*/
+
+LoadBalancer::LoadBalancer(const DisjointBoxLayout& a_dbl)
+{
+  define(a_dbl);
+}
+
+/*--------------------------------------------------------------------*/
+//  Weak construction
+/** Registered LevelData and Copiers are forgotten
+ *  \param[in]  a_dbl   Initial layout of boxes
+ *//*-----------------------------------------------------------------*/
+
+void
+LoadBalancer::define(const DisjointBoxLayout& a_dbl)
+{
+  m_disjointBoxLayout = a_dbl;
+  m_migrate.clear();
+  m_copier.clear();
+  resetCosts();
+}
+
+/*--------------------------------------------------------------------*/
+//  Reset all recorded costs
+/*--------------------------------------------------------------------*/
+
+void
+LoadBalancer::resetCosts()
+{
+  m_timer.assign(m_disjointBoxLayout.localSize(), Stopwatch<>());
+  m_cost.assign(m_disjointBoxLayout.localSize(), 0.);
+}
+
+/*--------------------------------------------------------------------*/
+//  Gather the costs of all boxes on all processes
+/** \param[out] a_globalCost
+ *                      Cost of each box indexed by the global index
+ *//*-----------------------------------------------------------------*/
+
+void
+LoadBalancer::gatherCosts(std::vector<double>& a_globalCost) const
+{
+  const DisjointBoxLayout& dbl = m_disjointBoxLayout;
+  a_globalCost.assign(dbl.size(), 0.);
+  std::vector<double> localCost(dbl.localSize());
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
+    {
+      localCost[(*dit).localIndex()] = cost(*dit);
+    }
+#ifdef USE_MPI
+  const int numProc = DisjointBoxLayout::numProc();
+  if (numProc > 1)
+    {
+      // Boxes on each process are contiguous in the global ordering
+      std::vector<int> counts(numProc, 0);
+      for (int idx = 0; idx != dbl.size(); ++idx)
+        {
+          ++counts[dbl.getLinear(idx).proc];
+        }
+      std::vector<int> displs(numProc, 0);
+      std::partial_sum(counts.begin(), counts.end() - 1, displs.begin() + 1);
+      MPI_Allgatherv(localCost.data(), dbl.localSize(), MPI_DOUBLE,
+                     a_globalCost.data(), counts.data(), displs.data(),
+                     MPI_DOUBLE, MPI_COMM_WORLD);
+      return;
+    }
+#endif
+  std::copy(localCost.begin(), localCost.end(),
+            a_globalCost.begin() + dbl.localIdxBegin());
+}
+
+/*--------------------------------------------------------------------*/
+//  Measured imbalance (maximum process cost / mean process cost)
+/** This is a collective operation
+ *//*-----------------------------------------------------------------*/
+
+double
+LoadBalancer::imbalance() const
+{
+  const DisjointBoxLayout& dbl = m_disjointBoxLayout;
+  std::vector<double> globalCost;
+  gatherCosts(globalCost);
+  std::vector<int> procs(dbl.size());
+  for (int idx = 0; idx != dbl.size(); ++idx)
+    {
+      procs[idx] = dbl.getLinear(idx).proc;
+    }
+  return imbalance(globalCost, procs, DisjointBoxLayout::numProc());
+}
+
+/*--------------------------------------------------------------------*/
+//  Redistribute the boxes if the imbalance exceeds a tolerance
+/** This is a collective operation.  Every process computes the same
+ *  assignment from the gathered costs.  Recorded costs are reset
+ *  whether or not the boxes are redistributed.
+ *  \param[in]  a_tolerance
+ *                      Redistribute if the imbalance (maximum process
+ *                      cost / mean process cost) exceeds this value
+ *                      and the new assignment is better
+ *  \return             T - boxes were redistributed
+ *//*-----------------------------------------------------------------*/
+
+bool
+LoadBalancer::rebalance(const double a_tolerance)
+{
+  const DisjointBoxLayout& dbl = m_disjointBoxLayout;
+  const int numProc = DisjointBoxLayout::numProc();
+  std::vector<double> globalCost;
+  gatherCosts(globalCost);
+  std::vector<int> procs(dbl.size());
+  for (int idx = 0; idx != dbl.size(); ++idx)
+    {
+      procs[idx] = dbl.getLinear(idx).proc;
+    }
+  const double curImbalance = imbalance(globalCost, procs, numProc);
+  bool redistributed = false;
+  if (curImbalance > a_tolerance)
+    {
+      partitionNodes(dbl, globalCost, DisjointBoxLayout::procNode(), procs);
+      if (imbalance(globalCost, procs, numProc) < curImbalance)
+        {
+          DisjointBoxLayout newDbl;
+          newDbl.defineReassign(dbl, procs);
+          for (auto& migrate : m_migrate)
+            {
+              migrate(newDbl);
+            }
+          for (Copier* copier : m_copier)
+            {
+              copier->redefine(newDbl);
+            }
+          m_disjointBoxLayout = newDbl;
+          redistributed = true;
+        }
+    }
+  resetCosts();
+  return redistributed;
+}
+
+/*--------------------------------------------------------------------*/
+//  Assign boxes to processes along a space-filling curve
+/** Boxes are sorted along a Morton (Z-order) curve based on the lower
+ *  corner of each box.  The curve is then cut into a_numProc
+ *  contiguous pieces with approximately equal cost.  A box is assigned
+ *  to the process in which the midpoint of its cost interval falls.
+ *  \param[in]  a_dbl   Layout of boxes
+ *  \param[in]  a_cost  Cost of each box (indexed by global index)
+ *  \param[in]  a_numProc
+ *                      Number of processes
+ *  \param[out] a_procs Process assigned to each box (indexed by
+ *                      global index)
+ *//*-----------------------------------------------------------------*/
+
+void
+LoadBalancer::partitionSFC(const DisjointBoxLayout&   a_dbl,
+                           const std::vector<double>& a_cost,
+                           const int                  a_numProc,
+                           std::vector<int>&          a_procs)
+{
+  const int numBox = a_dbl.size();
+  CH_assert((int)a_cost.size() == numBox);
+  CH_assert(a_numProc > 0);
+
+//--Morton keys interleaving the bits of the lower corner of each box
+
+  constexpr int c_numBit = 63/g_SpaceDim;
+  const IntVect& domainLo = a_dbl.problemDomain().loVect();
+  std::vector<uint64_t> key(numBox, 0);
+  for (int idx = 0; idx != numBox; ++idx)
+    {
+      const IntVect iv = a_dbl.getLinear(idx).box.loVect() - domainLo;
+      uint64_t k = 0;
+      for (int bit = 0; bit != c_numBit; ++bit)
+        {
+          for (int dir = 0; dir != g_SpaceDim; ++dir)
+            {
+              k |= (uint64_t)((iv[dir] >> bit) & 1) << (g_SpaceDim*bit + dir);
+            }
+        }
+      key[idx] = k;
+    }
+  std::vector<int> order(numBox);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&key](const int a_i, const int a_j)
+                   {
+                     return key[a_i] < key[a_j];
+                   });
+
+//--Cut the curve into pieces of equal cost.  With no cost information, each
+//--box is given unit cost.
+
+  double totalCost = 0.;
+  for (const double c : a_cost)
+    {
+      totalCost += std::max(c, 0.);
+    }
+  const bool useCost = (totalCost > 0.);
+  if (!useCost)
+    {
+      totalCost = numBox;
+    }
+  a_procs.assign(numBox, 0);
+  double prefix = 0.;
+  for (const int idx : order)
+    {
+      const double c = (useCost) ? std::max(a_cost[idx], 0.) : 1.;
+      const int proc = static_cast<int>(
+        (prefix + 0.5*c)*a_numProc/totalCost);
+      a_procs[idx] = std::min(proc, a_numProc - 1);
+      prefix += c;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Assign boxes to nodes and then processes by recursive bisection
+/** The boxes are first divided among the nodes, with the cost given
+ *  to each node proportional to its number of processes.  The boxes
+ *  on each node are then divided among its processes.  Each division
+ *  recursively cuts the boxes by a plane normal to the longest extent
+ *  of the box centers.  This gives compact blocks of boxes so that
+ *  most faces are between boxes on the same node.
+ *  \param[in]  a_dbl   Layout of boxes
+ *  \param[in]  a_cost  Cost of each box (indexed by global index)
+ *  \param[in]  a_procNode
+ *                      Node of each process (indexed by process)
+ *  \param[out] a_procs Process assigned to each box (indexed by
+ *                      global index)
+ *//*-----------------------------------------------------------------*/
+
+void
+LoadBalancer::partitionNodes(const DisjointBoxLayout&   a_dbl,
+                             const std::vector<double>& a_cost,
+                             const std::vector<int>&    a_procNode,
+                             std::vector<int>&          a_procs)
+{
+  const int numBox = a_dbl.size();
+  const int numProc = a_procNode.size();
+  CH_assert((int)a_cost.size() == numBox);
+  CH_assert(numProc > 0);
+
+  // With no cost information, each box is given unit cost
+  std::vector<double> cost(numBox);
+  double totalCost = 0.;
+  for (int idx = 0; idx != numBox; ++idx)
+    {
+      cost[idx] = std::max(a_cost[idx], 0.);
+      totalCost += cost[idx];
+    }
+  if (totalCost <= 0.)
+    {
+      cost.assign(numBox, 1.);
+    }
+
+//--Divide among nodes, weighted by the number of processes on each
+
+  const int numNode =
+    *std::max_element(a_procNode.begin(), a_procNode.end()) + 1;
+  std::vector<int> nodes(numNode);
+  std::iota(nodes.begin(), nodes.end(), 0);
+  std::vector<double> nodeWeight(numNode, 0.);
+  for (const int node : a_procNode)
+    {
+      nodeWeight[node] += 1.;
+    }
+  std::vector<int> boxes(numBox);
+  std::iota(boxes.begin(), boxes.end(), 0);
+  std::vector<int> boxNode(numBox, 0);
+  bisect(a_dbl, cost, boxes, 0, numBox, nodes, 0, numNode, nodeWeight,
+         boxNode);
+
+//--Divide the boxes on each node among its processes
+
+  a_procs.assign(numBox, 0);
+  for (int node = 0; node != numNode; ++node)
+    {
+      std::vector<int> nodeProcs;
+      for (int iProc = 0; iProc != numProc; ++iProc)
+        {
+          if (a_procNode[iProc] == node) nodeProcs.push_back(iProc);
+        }
+      std::vector<int> nodeBoxes;
+      for (int idx = 0; idx != numBox; ++idx)
+        {
+          if (boxNode[idx] == node) nodeBoxes.push_back(idx);
+        }
+      const std::vector<double> procWeight(nodeProcs.size(), 1.);
+      bisect(a_dbl, cost, nodeBoxes, 0, nodeBoxes.size(), nodeProcs, 0,
+             nodeProcs.size(), procWeight, a_procs);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Imbalance of a process assignment
+/** \param[in]  a_cost  Cost of each box
+ *  \param[in]  a_procs Process assigned to each box
+ *  \param[in]  a_numProc
+ *                      Number of processes
+ *  \return             Maximum process cost / mean process cost (1 if
+ *                      there is no cost)
+ *//*-----------------------------------------------------------------*/
+
+double
+LoadBalancer::imbalance(const std::vector<double>& a_cost,
+                        const std::vector<int>&    a_procs,
+                        const int                  a_numProc)
+{
+  CH_assert(a_cost.size() == a_procs.size());
+  std::vector<double> procCost(a_numProc, 0.);
+  for (int idx = 0, idx_end = a_cost.size(); idx != idx_end; ++idx)
+    {
+      procCost[a_procs[idx]] += a_cost[idx];
+    }
+  const double totalCost =
+    std::accumulate(procCost.begin(), procCost.end(), 0.);
+  if (totalCost <= 0.) return 1.;
+  return *std::max_element(procCost.begin(), procCost.end())*a_numProc/
+    totalCost;
+}
+
+/*--------------------------------------------------------------------*/
+//  Recursively bisect boxes among parts
+/** The parts are split into two halves and the boxes are cut, normal
+ *  to the direction with the largest extent of box centers, so that
+ *  the cost on each side is proportional to the weight of each half.
+ *  \param[in]  a_dbl   Layout of boxes
+ *  \param[in]  a_cost  Cost of each box (indexed by global index)
+ *  \param[in]  a_boxes Global indices of boxes.  The range to bisect
+ *                      is reordered.
+ *  \param[in]  a_boxBeg
+ *                      Begin of range in a_boxes
+ *  \param[in]  a_boxEnd
+ *                      End of range in a_boxes
+ *  \param[in]  a_parts Parts (nodes or processes) to assign
+ *  \param[in]  a_partBeg
+ *                      Begin of range in a_parts
+ *  \param[in]  a_partEnd
+ *                      End of range in a_parts
+ *  \param[in]  a_partWeight
+ *                      Weight of each part (indexed as a_parts)
+ *  \param[out] a_assign
+ *                      Part assigned to each box (indexed by global
+ *                      index)
+ *//*-----------------------------------------------------------------*/
+
+void
+LoadBalancer::bisect(const DisjointBoxLayout&   a_dbl,
+                     const std::vector<double>& a_cost,
+                     std::vector<int>&          a_boxes,
+                     const int                  a_boxBeg,
+                     const int                  a_boxEnd,
+                     const std::vector<int>&    a_parts,
+                     const int                  a_partBeg,
+                     const int                  a_partEnd,
+                     const std::vector<double>& a_partWeight,
+                     std::vector<int>&          a_assign)
+{
+  CH_assert(a_partEnd > a_partBeg);
+  if (a_partEnd - a_partBeg == 1)
+    {
+      for (int i = a_boxBeg; i != a_boxEnd; ++i)
+        {
+          a_assign[a_boxes[i]] = a_parts[a_partBeg];
+        }
+      return;
+    }
+  if (a_boxBeg == a_boxEnd) return;
+
+  // Fraction of the cost for the lower half of the parts
+  const int partMid = a_partBeg + (a_partEnd - a_partBeg)/2;
+  const double weightLo = std::accumulate(a_partWeight.begin() + a_partBeg,
+                                          a_partWeight.begin() + partMid, 0.);
+  const double weightHi = std::accumulate(a_partWeight.begin() + partMid,
+                                          a_partWeight.begin() + a_partEnd,
+                                          0.);
+
+  // Cut normal to the direction with the largest extent of box centers.
+  // Centers are doubled to keep them as integers.
+  IntVect centerLo = a_dbl.getLinear(a_boxes[a_boxBeg]).box.loVect();
+  centerLo = centerLo + centerLo;
+  IntVect centerHi = centerLo;
+  double totalCost = 0.;
+  for (int i = a_boxBeg; i != a_boxEnd; ++i)
+    {
+      const Box box = a_dbl.getLinear(a_boxes[i]).box;
+      const IntVect center = box.loVect() + box.hiVect();
+      centerLo.min(center);
+      centerHi.max(center);
+      totalCost += a_cost[a_boxes[i]];
+    }
+  const IntVect extent = centerHi - centerLo;
+  int cutDir = 0;
+  for (int dir = 1; dir != g_SpaceDim; ++dir)
+    {
+      if (extent[dir] > extent[cutDir]) cutDir = dir;
+    }
+  std::sort(a_boxes.begin() + a_boxBeg, a_boxes.begin() + a_boxEnd,
+            [&a_dbl, cutDir](const int a_i, const int a_j)
+            {
+              const Box boxI = a_dbl.getLinear(a_i).box;
+              const Box boxJ = a_dbl.getLinear(a_j).box;
+              const int centerI = boxI.loVect(cutDir) + boxI.hiVect(cutDir);
+              const int centerJ = boxJ.loVect(cutDir) + boxJ.hiVect(cutDir);
+              return (centerI < centerJ) || (centerI == centerJ && a_i < a_j);
+            });
+
+  // A box is on the lower side if the midpoint of its cost interval is
+  const double costLo = totalCost*weightLo/(weightLo + weightHi);
+  double prefix = 0.;
+  int boxMid = a_boxBeg;
+  for (int i = a_boxBeg; i != a_boxEnd; ++i)
+    {
+      const double c = a_cost[a_boxes[i]];
+      if (prefix + 0.5*c > costLo) break;
+      prefix += c;
+      boxMid = i + 1;
+    }
+  bisect(a_dbl, a_cost, a_boxes, a_boxBeg, boxMid, a_parts, a_partBeg,
+         partMid, a_partWeight, a_assign);
+  bisect(a_dbl, a_cost, a_boxes, boxMid, a_boxEnd, a_parts, partMid,
+         a_partEnd, a_partWeight, a_assign);
+}
@@ -0,0 +1,210 @@
+
+/******************************************************************************/
+/**
+ * \file ScratchArena.cpp
+ *
+ * \brief Non-inline definitions for classes in ScratchArena.H
+ *
+ *//*+*************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+
+#include "ScratchArena.H"
+#include "LinuxSupport.H"
+
+namespace
+{
+
+/// Largest high-water mark of any thread
+std::atomic<size_t> s_maxHighWater(0);
+
+}  // anonymous namespace
+
+
+/*******************************************************************************
+ *
+ * Class ScratchArena: member definitions
+ *
+ ******************************************************************************/
+
+constexpr size_t ScratchArena::c_alignment;
+constexpr size_t ScratchArena::c_minChunk;
+
+/*--------------------------------------------------------------------*/
+//  Default constructor
+/** No memory is allocated until first used
+ *//*-----------------------------------------------------------------*/
+
+ScratchArena::ScratchArena()
+  :
+  m_chunk(),
+  m_curChunk(0),
+  m_offset(0),
+  m_inUse(0),
+  m_highWater(0),
+  m_numChunkAlloc(0)
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Destructor
+/*--------------------------------------------------------------------*/
+
+ScratchArena::~ScratchArena()
+{
+  CH_assert(m_inUse == 0);
+  freeChunks(0);
+}
+
+/*--------------------------------------------------------------------*/
+//  The arena of the calling thread
+/** The arena is constructed on first use and destroyed when the
+ *  thread exits
+ *//*-----------------------------------------------------------------*/
+
+ScratchArena&
+ScratchArena::local()
+{
+  thread_local ScratchArena arena;
+  return arena;
+}
+
+/*--------------------------------------------------------------------*/
+//  Allocate aligned memory
+/** Memory is only allocated from the system if the current chunk,
+ *  and the one after it, are too small
+ *  \param[in]  a_bytes Number of bytes
+ *  \return             Memory aligned to c_alignment bytes (never
+ *                      nullptr, even for 0 bytes)
+ *//*-----------------------------------------------------------------*/
+
+void*
+ScratchArena::allocate(size_t a_bytes)
+{
+  a_bytes = std::max(((a_bytes + c_alignment - 1)/c_alignment)*c_alignment,
+                     c_alignment);
+  if (m_chunk.empty() || m_offset + a_bytes > m_chunk[m_curChunk].size)
+    {
+      const size_t next = (m_chunk.empty()) ? 0 : m_curChunk + 1;
+      if (next >= m_chunk.size() || m_chunk[next].size < a_bytes)
+        {
+          // Chunks after the current one are unused
+          const size_t size =
+            std::max(std::max(a_bytes, 2*capacity()), c_minChunk);
+          freeChunks(next);
+          appendChunk(size);
+        }
+      m_curChunk = next;
+      m_offset = 0;
+    }
+  void *const addr = m_chunk[m_curChunk].mem + m_offset;
+  m_offset += a_bytes;
+  m_inUse += a_bytes;
+  if (m_inUse > m_highWater)
+    {
+      m_highWater = m_inUse;
+      size_t maxHighWater = s_maxHighWater;
+      while (maxHighWater < m_highWater &&
+             !s_maxHighWater.compare_exchange_weak(maxHighWater, m_highWater));
+    }
+  return addr;
+}
+
+/*--------------------------------------------------------------------*/
+//  Release all memory allocated since a marker
+/** If the arena becomes empty and has more than one chunk, the chunks
+ *  are replaced by one chunk of the total capacity
+ *  \param[in]  a_marker
+ *                      Position from mark()
+ *//*-----------------------------------------------------------------*/
+
+void
+ScratchArena::release(const Marker& a_marker)
+{
+  CH_assert(a_marker.inUse <= m_inUse);
+  CH_assert(m_chunk.empty() || a_marker.chunk <= m_curChunk);
+  m_curChunk = a_marker.chunk;
+  m_offset = a_marker.offset;
+  m_inUse = a_marker.inUse;
+  if (m_inUse == 0 && m_chunk.size() > 1)
+    {
+      const size_t size = capacity();
+      freeChunks(0);
+      appendChunk(size);
+      m_curChunk = 0;
+      m_offset = 0;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+//  Bytes in all chunks
+/*--------------------------------------------------------------------*/
+
+size_t
+ScratchArena::capacity() const
+{
+  size_t size = 0;
+  for (const Chunk& chunk : m_chunk)
+    {
+      size += chunk.size;
+    }
+  return size;
+}
+
+/*--------------------------------------------------------------------*/
+//  Most bytes ever in use by any thread
+/*--------------------------------------------------------------------*/
+
+size_t
+ScratchArena::maxHighWater()
+{
+  return s_maxHighWater;
+}
+
+/*--------------------------------------------------------------------*/
+//  Write the high-water marks
+/** \param[in]  a_os    Stream to write to
+ *//*-----------------------------------------------------------------*/
+
+void
+ScratchArena::report(std::ostream& a_os) const
+{
+  a_os << "Scratch arena high water (bytes): " << m_highWater
+       << " (this thread), " << maxHighWater() << " (any thread)\n"
+       << "Scratch arena capacity (bytes)  : " << capacity() << " in "
+       << m_chunk.size() << " chunks, " << m_numChunkAlloc
+       << " system allocations\n";
+}
+
+/*--------------------------------------------------------------------*/
+//  Free chunks
+/** \param[in]  a_beg   Index of first chunk to free
+ *//*-----------------------------------------------------------------*/
+
+void
+ScratchArena::freeChunks(const size_t a_beg)
+{
+  for (size_t i = a_beg; i < m_chunk.size(); ++i)
+    {
+      System::freeLarge(m_chunk[i].mem);
+    }
+  m_chunk.resize(std::min(a_beg, m_chunk.size()));
+}
+
+/*--------------------------------------------------------------------*/
+//  Append a chunk from the system
+/** Large chunks are placed on huge pages (see System::memalignLarge)
+ *  \param[in]  a_bytes Size of the chunk
+ *//*-----------------------------------------------------------------*/
+
+void
+ScratchArena::appendChunk(const size_t a_bytes)
+{
+  void* addr = nullptr;
+  const int err = System::memalignLarge(&addr, c_alignment, a_bytes);
+  CH_assert(err == 0);
+  (void)err;
+  m_chunk.push_back({ static_cast<char*>(addr), a_bytes });
+  ++m_numChunkAlloc;
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#include "BaseFab.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "AMRHierarchy.H"
+
+// Linear function of the cell center (dx = 1 on level 0)
+Real linear(const IntVect& a_iv, const Real a_dx)
+{
+  return (a_iv[0] + 0.5)*a_dx + 2.*(a_iv[1] + 0.5)*a_dx;
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  // Level 0 is 16 x 16 x 4 cells.  Level 1 (ratio 2) has 2 boxes covering
+  // coarse cells 4 to 11 in x and y.
+  const Box crDomain(IntVect::Zero, IntVect(D_DECL(15, 15, 3)));
+  const DisjointBoxLayout crDbl(crDomain, IntVect(D_DECL(8, 8, 4)));
+  Box fnDomain(crDomain);
+  fnDomain.refine(2);
+  const Box fnCover(IntVect(D_DECL(8, 8, 0)), IntVect(D_DECL(23, 23, 7)));
+  const std::vector<Box> fnBoxes{
+    Box(IntVect(D_DECL( 8, 8, 0)), IntVect(D_DECL(15, 23, 7))),
+    Box(IntVect(D_DECL(16, 8, 0)), IntVect(D_DECL(23, 23, 7))) };
+  const DisjointBoxLayout fnDbl(fnDomain, fnBoxes, std::vector<int>(2, 0));
+
+  AMRHierarchy amr(crDbl, 1, 2);
+  if (amr.addLevel(fnDbl, 2) != 1) ++status;
+  if (amr.numLevel() != 2 || amr.refRatio(1) != 2) ++status;
+
+  // Refining and coarsening boxes
+  {
+    Box box(IntVect(D_DECL(-3, 0, 2)), IntVect(D_DECL(-1, 4, 5)));
+    box.coarsen(2);
+    if (box != Box(IntVect(D_DECL(-2, 0, 1)), IntVect(D_DECL(-1, 2, 2))))
+      ++status;
+    box.refine(2);
+    if (box != Box(IntVect(D_DECL(-4, 0, 2)), IntVect(D_DECL(-1, 5, 5))))
+      ++status;
+    if (!box.coarsenable(2) || fnBoxes[0].coarsenable(16)) ++status;
+  }
+
+  // Linear data on level 0 is interpolated exactly to the ghost cells of
+  // level 1
+  {
+    for (DataIterator dit(crDbl); dit.ok(); ++dit)
+      {
+        FArrayBox& fab = amr.data(0)[dit];
+        for (BoxIterator bit(crDbl[dit]); bit.ok(); ++bit)
+          {
+            fab(*bit, 0) = linear(*bit, 1.);
+          }
+      }
+    LevelData<FArrayBox>& fnData = amr.data(1);
+    fnData.setVal(-1.);
+    for (DataIterator dit(fnDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(fnDbl[dit]); bit.ok(); ++bit)
+          {
+            fnData[dit](*bit, 0) = linear(*bit, 0.5);
+          }
+      }
+    amr.fillGhosts(1, fnData, amr.time(1));
+    int numErr = 0;
+    for (DataIterator dit(fnDbl); dit.ok(); ++dit)
+      {
+        const FArrayBox& fab = fnData[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            const Real expected = fnDomain.contains(*bit) ?
+              linear(*bit, 0.5) : -1.;
+            if (std::fabs(fab(*bit, 0) - expected) > 1.E-12) ++numErr;
+          }
+      }
+    if (verbose)
+      {
+        std::cout << "Interpolation errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Averaging is conservative and only modifies covered coarse cells
+  {
+    LevelData<FArrayBox>& crData = amr.data(0);
+    LevelData<FArrayBox>& fnData = amr.data(1);
+    crData.setVal(-1.);
+    Real fnSum = 0.;
+    for (DataIterator dit(fnDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(fnDbl[dit]); bit.ok(); ++bit)
+          {
+            const IntVect& iv = *bit;
+            const Real val = iv[0]*iv[1] + D_TERM(0., + iv[1], + iv[2]);
+            fnData[dit](iv, 0) = val;
+            fnSum += val;
+          }
+      }
+    amr.averageDown(1);
+    Box crCover(fnCover);
+    crCover.coarsen(2);
+    Real crSum = 0.;
+    for (DataIterator dit(crDbl); dit.ok(); ++dit)
+      {
+        const FArrayBox& fab = crData[dit];
+        for (BoxIterator bit(crDbl[dit]); bit.ok(); ++bit)
+          {
+            if (crCover.contains(*bit))
+              {
+                crSum += fab(*bit, 0);
+              }
+            else if (fab(*bit, 0) != -1.)
+              {
+                ++status;
+              }
+          }
+      }
+    const int volRatio = (2*IntVect::Unit).product();
+    if (std::fabs(crSum*volRatio - fnSum) > 1.E-9*std::fabs(fnSum)) ++status;
+    if (verbose)
+      {
+        std::cout << "Fine sum: " << fnSum << ", coarse sum: "
+                  << crSum*volRatio << std::endl;
+      }
+  }
+
+  // Subcycling.  Level 0 steps from 0 to 1 and level 1 adds 0.25 per step.
+  // Coarse-fine ghosts are interpolated in time.
+  {
+    const Real dt = 0.1;
+    amr.setTime(0.);
+    amr.data(0).setVal(0.);
+    amr.data(1).setVal(0.);
+    std::vector<int> stepLvl;
+    std::vector<Real> stepTime;
+    auto step =
+      [&](const int a_lvl, const Real a_time, const Real a_dt)
+      {
+        stepLvl.push_back(a_lvl);
+        stepTime.push_back(a_time);
+        const DisjointBoxLayout& dbl = amr.disjointBoxLayout(a_lvl);
+        if (a_lvl == 0)
+          {
+            if (a_dt != dt) ++status;
+            amr.data(0).setVal(1.);
+            return;
+          }
+        if (std::fabs(a_dt - 0.5*dt) > 1.E-15) ++status;
+        // Ghosts between fine boxes hold fine data, others coarse data
+        const Real alpha = a_time/dt;
+        for (DataIterator dit(dbl); dit.ok(); ++dit)
+          {
+            const FArrayBox& fabOld = amr.dataOld(1)[dit];
+            for (BoxIterator bit(fabOld.box()); bit.ok(); ++bit)
+              {
+                if (!fnDomain.contains(*bit)) continue;
+                const Real expected = fnCover.contains(*bit) ?
+                  0.5*alpha : alpha;
+                if (std::fabs(fabOld(*bit, 0) - expected) > 1.E-12) ++status;
+              }
+            FArrayBox& fab = amr.data(1)[dit];
+            for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+              {
+                fab(*bit, 0) = fabOld(*bit, 0) + 0.25;
+              }
+          }
+      };
+    amr.advance(dt, step);
+    if (stepLvl != std::vector<int>({ 0, 1, 1 })) ++status;
+    if (stepTime.size() != 3 || stepTime[0] != 0. || stepTime[1] != 0. ||
+        std::fabs(stepTime[2] - 0.5*dt) > 1.E-15) ++status;
+    if (amr.time(0) != dt || amr.time(1) != dt) ++status;
+    // Covered coarse cells hold the fine average
+    Box crCover(fnCover);
+    crCover.coarsen(2);
+    for (DataIterator dit(crDbl); dit.ok(); ++dit)
+      {
+        const FArrayBox& fab = amr.data(0)[dit];
+        for (BoxIterator bit(crDbl[dit]); bit.ok(); ++bit)
+          {
+            if (fab(*bit, 0) != (crCover.contains(*bit) ? 0.5 : 1.)) ++status;
+          }
+      }
+  }
+
+  // A coarser level removes the finer levels
+  amr.truncate(1);
+  if (amr.numLevel() != 1) ++status;
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testAMRHierarchy";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -1,9 +1,14 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 #include "BaseFab.H"
+#include "BaseFabMacros.H"
 #include "BoxIterator.H"
+#include "LinuxSupport.H"
 
 int main(const int argc, const char* argv[])
 {
@@ -261,6 +266,484 @@ int main(const int argc, const char* argv[])
   }
 #endif
 
+  // Test views of a region of a BaseFab
+  {
+    int statusV = 0;
+    const Box boxV(IntVect::Zero, IntVect(D_DECL(2, 2, 2)));
+    Box boxB(boxV);
+    boxB.grow(2);
+    FArrayBox fabB(boxB, 2, -1.);
+    FArrayBox view;
+    view.defineView(fabB, boxV);
+    if (view.contiguous() || !fabB.contiguous()) ++statusV;
+    if (view.box() != boxV || view.ncomp() != 2) ++statusV;
+    if (view.size() != testSizeA) ++statusV;
+    if (view.getArrayDims() != boxB.dimensions()) ++statusV;
+    // Setting the view only modifies the region
+    view.setVal(1, 2.);
+    for (BoxIterator bit(boxB); bit.ok(); ++bit)
+      {
+        if (fabB(*bit, 0) != -1.) ++statusV;
+        if (fabB(*bit, 1) != ((boxV.contains(*bit)) ? 2. : -1.)) ++statusV;
+      }
+    // Kernels using multi-dimensional arrays work on the view
+    {
+      MD_ARRAY_RESTRICT(arrV, view);
+      MD_BOXLOOP(boxV, i)
+        {
+          arrV[MD_IX(i, 0)] = D_TERM(i0, + 10*i1, + 100*i2);
+        }
+    }
+    for (BoxIterator bit(boxB); bit.ok(); ++bit)
+      {
+        const IntVect& iv = *bit;
+        const Real val = (boxV.contains(iv)) ?
+          D_TERM(iv[0], + 10*iv[1], + 100*iv[2]) : -1.;
+        if (fabB(iv, 0) != val) ++statusV;
+        if (boxV.contains(iv) && view(iv, 0) != val) ++statusV;
+      }
+    // Copy out of the view
+    FArrayBox fabC(boxV, 2, 0.);
+    fabC.copy(boxV, view);
+    for (BoxIterator bit(boxV); bit.ok(); ++bit)
+      {
+        if (fabC(*bit, 0) != view(*bit, 0) || fabC(*bit, 1) != 2.) ++statusV;
+      }
+    if (verbose || statusV != 0)
+      {
+        std::cout << "View test " << statLbl[(statusV == 0)] << std::endl;
+      }
+    status += statusV;
+  }
+
+  // Test views of a range of components
+  {
+    int statusC = 0;
+    const Box boxV(IntVect::Zero, IntVect(D_DECL(2, 2, 2)));
+    Box boxB(boxV);
+    boxB.grow(1);
+    const auto val =
+      [](const IntVect& a_iv, const int a_icomp)
+      {
+        return D_TERM(a_iv[0], + 10*a_iv[1], + 100*a_iv[2]) + 1000*a_icomp;
+      };
+    FArrayBox fabB(boxB, 4);
+    for (BoxIterator bit(boxB); bit.ok(); ++bit)
+      {
+        for (int c = 0; c != 4; ++c)
+          {
+            fabB(*bit, c) = val(*bit, c);
+          }
+      }
+    // Components 1 and 2 over the whole box, then only component 2 of
+    // the region (a view of a view)
+    FArrayBox viewC(fabB, boxB, 1, 2);
+    FArrayBox viewR;
+    viewR.defineView(viewC, boxV, 1, 1);
+    if (viewC.ncomp() != 2 || viewC.contiguous() ||
+        viewC.dataPtr(0) != fabB.dataPtr(1) ||
+        &viewR(boxV.loVect(), 0) != &fabB(boxV.loVect(), 2)) ++statusC;
+    if (viewC.sum(boxB, 0, 1) != fabB.sum(boxB, 1, 2)) ++statusC;
+    // Operations only modify the viewed components and region
+    viewR.mult(2., boxV, 0, 1);
+    viewC.setVal(0, -1.);
+    {
+      MD_ARRAY_RESTRICT(arrR, viewR);
+      MD_BOXLOOP(boxV, i)
+        {
+          arrR[MD_IX(i, 0)] += 1.;
+        }
+    }
+    for (BoxIterator bit(boxB); bit.ok(); ++bit)
+      {
+        const IntVect& iv = *bit;
+        const Real val2 = (boxV.contains(iv)) ?
+          2.*val(iv, 2) + 1. : val(iv, 2);
+        if (fabB(iv, 0) != val(iv, 0) || fabB(iv, 1) != -1. ||
+            fabB(iv, 2) != val2 || fabB(iv, 3) != val(iv, 3)) ++statusC;
+      }
+    // Linear buffers and copies use the viewed components
+    std::vector<Real> buffer(2*boxB.size());
+    viewC.linearOut(buffer.data(), boxB, 0, 2);
+    FArrayBox fabC(boxB, 2);
+    fabC.linearIn(buffer.data(), boxB, 0, 2);
+    FArrayBox fabD(boxB, 2, 0.);
+    fabD.copy(boxB, viewC);
+    for (BoxIterator bit(boxB); bit.ok(); ++bit)
+      {
+        for (int c = 0; c != 2; ++c)
+          {
+            if (fabC(*bit, c) != fabB(*bit, c + 1) ||
+                fabD(*bit, c) != fabB(*bit, c + 1)) ++statusC;
+          }
+      }
+    // Interleaved layouts
+    BaseFab<Real, LayoutAoS> fabA(boxB, 4, 0.);
+    BaseFab<Real, LayoutAoS> viewA(fabA, boxV, 3, 1);
+    viewA.setVal(3.);
+    {
+      MD_LAYOUT_ARRAY(arrA, viewA);
+      MD_BOXLOOP(boxV, i)
+        {
+          if (arrA[MD_IX(i, 0)] != 3.) ++statusC;
+        }
+    }
+    if (fabA.sum(boxB, 3, 4) != 3.*boxV.size() ||
+        fabA.sum(boxB, 0, 3) != 0.) ++statusC;
+    if (verbose || statusC != 0)
+      {
+        std::cout << "Component view test " << statLbl[(statusC == 0)]
+                  << std::endl;
+      }
+    status += statusC;
+  }
+
+  // Test aligned allocation and padded strides
+  {
+    int statusP = 0;
+    const auto aligned =
+      [](const void* a_p)
+      {
+        return reinterpret_cast<std::uintptr_t>(a_p) %
+          FArrayBox::s_alignment == 0;
+      };
+    const Box boxP(IntVect(D_DECL(-1, -1, -1)), IntVect(D_DECL(4, 2, 2)));
+    const int numAlign = FArrayBox::s_alignment/sizeof(Real);
+    FArrayBox fabU(boxP, 2);
+    if (!aligned(fabU.dataPtr()) || !fabU.contiguous()) ++statusP;
+    FArrayBox::setPadStride(true);
+    FArrayBox fabP(boxP, 2, -1.);
+    FArrayBox::setPadStride(false);
+    if (fabP.contiguous() || fabP.size() != 2*boxP.size()) ++statusP;
+    if (fabP.getStride()[1] != numAlign ||
+        fabP.getArrayDims()[0] != numAlign ||
+        fabP.getArrayDims()[1] != boxP.dimensions()[1]) ++statusP;
+    if (fabP.sizeBytes() !=
+        2*fabP.getComponentStride()*sizeof(Real)) ++statusP;
+    // Each pencil in x starts aligned
+    for (int ic = 0; ic != 2; ++ic)
+      {
+        for (BoxIterator bit(boxP); bit.ok(); ++bit)
+          {
+            if ((*bit)[0] == boxP.loVect()[0] && !aligned(&fabP(*bit, ic)))
+              ++statusP;
+          }
+      }
+    // Multi-dimensional arrays index the padded data
+    {
+      MD_ARRAY_RESTRICT(arrP, fabP);
+      for (int ic = 0; ic != 2; ++ic)
+        {
+          MD_BOXLOOP(boxP, i)
+            {
+              arrP[MD_IX(i, ic)] = D_TERM(i0, + 10*i1, + 100*i2) + 1000*ic;
+            }
+        }
+    }
+    for (BoxIterator bit(boxP); bit.ok(); ++bit)
+      {
+        const IntVect& iv = *bit;
+        const Real val = D_TERM(iv[0], + 10*iv[1], + 100*iv[2]);
+        if (fabP(iv, 0) != val || fabP(iv, 1) != val + 1000.) ++statusP;
+      }
+    // Copies and linear buffers between padded and unpadded data
+    fabU.setVal(0.);
+    fabU.copy(boxP, fabP);
+    std::vector<Real> buffer(2*boxP.size());
+    fabP.linearOut(buffer.data(), boxP, 0, 2);
+    FArrayBox fabL(boxP, 2, 0.);
+    fabL.linearIn(buffer.data(), boxP, 0, 2);
+    for (BoxIterator bit(boxP); bit.ok(); ++bit)
+      {
+        for (int ic = 0; ic != 2; ++ic)
+          {
+            if (fabU(*bit, ic) != fabP(*bit, ic) ||
+                fabL(*bit, ic) != fabP(*bit, ic)) ++statusP;
+          }
+      }
+    // Setting a component does not modify the others
+    fabP.setVal(1, 3.);
+    for (BoxIterator bit(boxP); bit.ok(); ++bit)
+      {
+        if (fabP(*bit, 0) != fabU(*bit, 0) || fabP(*bit, 1) != 3.) ++statusP;
+      }
+    if (verbose || statusP != 0)
+      {
+        std::cout << "Padded test " << statLbl[(statusP == 0)] << std::endl;
+      }
+    status += statusP;
+  }
+
+  // Test assigning by the threads of MD_BOXLOOP_OMP, including ghosts and
+  // padding
+  {
+    int statusT = 0;
+    Box boxT(IntVect::Zero, IntVect(D_DECL(4, 3, 5)));
+    Box boxG(boxT);
+    boxG.grow(2);
+    FArrayBox::setPadStride(true);
+    FArrayBox fabT(boxG, 2);
+    FArrayBox::setPadStride(false);
+    fabT.setValOMP(4., boxT);
+    for (int n = 0, n_end = 2*fabT.getComponentStride(); n != n_end; ++n)
+      {
+        if (fabT.dataPtr()[n] != 4.) ++statusT;
+      }
+    // A view only sets its region
+    FArrayBox view;
+    view.defineView(fabT, boxT);
+    view.setValOMP(5., boxT);
+    for (BoxIterator bit(boxG); bit.ok(); ++bit)
+      {
+        const Real val = (boxT.contains(*bit)) ? 5. : 4.;
+        if (fabT(*bit, 0) != val || fabT(*bit, 1) != val) ++statusT;
+      }
+    if (verbose || statusT != 0)
+      {
+        std::cout << "Threaded set test " << statLbl[(statusT == 0)]
+                  << std::endl;
+      }
+    status += statusT;
+  }
+
+  // Test large BaseFabs on huge pages
+  {
+    int statusH = 0;
+    const auto largeBytes =
+      [](const System::HugePageCounters& a_counters)
+      {
+        return a_counters.bytesHugetlb + a_counters.bytesAdvised +
+          a_counters.bytesFallback;
+      };
+    const Box boxH(IntVect::Zero, IntVect(D_DECL(63, 63, 63)));
+    const System::HugePageCounters counters0 = System::hugePageCounters();
+    {
+      FArrayBox fabH(boxH, 2);
+      const System::HugePageCounters counters1 = System::hugePageCounters();
+      if (fabH.sizeBytes() < System::hugePageThreshold() ||
+          largeBytes(counters1) - largeBytes(counters0) < fabH.sizeBytes())
+        ++statusH;
+      if (reinterpret_cast<std::uintptr_t>(fabH.dataPtr()) %
+          FArrayBox::s_alignment != 0) ++statusH;
+      fabH.setVal(1, 2.);
+      fabH.setVal(0, 1.);
+      if (fabH(boxH.hiVect(), 1) != 2. || fabH(boxH.loVect(), 0) != 1.)
+        ++statusH;
+      if (verbose)
+        {
+          std::cout << "Bytes on huge pages (hugetlb, advised, fallback): "
+                    << counters1.bytesHugetlb << ", "
+                    << counters1.bytesAdvised << ", "
+                    << counters1.bytesFallback << std::endl;
+          std::cout << "Transparent huge page bytes: "
+                    << System::anonHugePageBytes() << std::endl;
+        }
+    }
+    // Without a threshold, all allocations are small
+    const size_t threshold = System::hugePageThreshold();
+    System::setHugePageThreshold(0);
+    {
+      const System::HugePageCounters counters1 = System::hugePageCounters();
+      FArrayBox fabH(boxH, 1);
+      const System::HugePageCounters counters2 = System::hugePageCounters();
+      if (largeBytes(counters2) != largeBytes(counters1) ||
+          counters2.bytesSmall - counters1.bytesSmall != fabH.sizeBytes())
+        ++statusH;
+    }
+    System::setHugePageThreshold(threshold);
+    if (verbose || statusH != 0)
+      {
+        std::cout << "Huge page test " << statLbl[(statusH == 0)]
+                  << std::endl;
+      }
+    status += statusH;
+  }
+
+  // Test interleaved layouts.  The box is not a whole number of AoSoA
+  // blocks in x.
+  {
+    int statusL = 0;
+    using AoSFab = BaseFab<Real, LayoutAoS>;
+    using AoSoAFab = BaseFab<Real, LayoutAoSoA<4>>;
+    const Box boxL(IntVect(D_DECL(-1, 0, 2)), IntVect(D_DECL(5, 2, 3)));
+    const IntVect ivx(D_DECL(1, 0, 0));
+    const auto val =
+      [](const IntVect& a_iv, const int a_icomp)
+      {
+        return D_TERM(a_iv[0], + 10*a_iv[1], + 100*a_iv[2]) + 1000.*a_icomp;
+      };
+    FArrayBox fabS(boxL, 3);
+    for (BoxIterator bit(boxL); bit.ok(); ++bit)
+      {
+        for (int ic = 0; ic != 3; ++ic)
+          {
+            fabS(*bit, ic) = val(*bit, ic);
+          }
+      }
+    // Components of a cell are adjacent (AoS) or a block apart (AoSoA)
+    AoSFab fabA(boxL, 3, -1.);
+    AoSoAFab fabB(boxL, 3, -1.);
+    const IntVect iv0 = boxL.loVect();
+    if (&fabA(iv0, 1) - &fabA(iv0, 0) != 1 ||
+        &fabA(iv0 + ivx, 0) - &fabA(iv0, 0) != 3) ++statusL;
+    if (&fabB(iv0, 1) - &fabB(iv0, 0) != 4 ||
+        &fabB(iv0 + ivx, 0) - &fabB(iv0, 0) != 1 ||
+        &fabB(iv0 + 4*ivx, 0) - &fabB(iv0, 0) != 12) ++statusL;
+    if (!fabA.contiguous() || fabA.sizeBytes() != 3*boxL.size()*sizeof(Real))
+      ++statusL;
+    const size_t numB = AoSoAFab::aliasSize(boxL, 3);
+    if (fabB.contiguous() || numB != 3*8*(size_t)(boxL.size()/7) ||
+        fabB.sizeBytes() != numB*sizeof(Real)) ++statusL;
+    // Copies between layouts
+    fabA.copy(boxL, 0, fabS, boxL, 0, 3);
+    fabB.copy(boxL, 0, fabA, boxL, 0, 3);
+    for (BoxIterator bit(boxL); bit.ok(); ++bit)
+      {
+        for (int ic = 0; ic != 3; ++ic)
+          {
+            if (fabA(*bit, ic) != val(*bit, ic) ||
+                fabB(*bit, ic) != val(*bit, ic)) ++statusL;
+          }
+      }
+    // Multi-dimensional arrays index the interleaved data
+    {
+      MD_LAYOUT_ARRAY(arrB, fabB);
+      MD_LAYOUT_ARRAY(arrS, fabS);
+      MD_BOXLOOP(boxL, i)
+        {
+          arrB[MD_IX(i, 2)] += arrS[MD_IX(i, 0)];
+        }
+    }
+    for (BoxIterator bit(boxL); bit.ok(); ++bit)
+      {
+        if (fabB(*bit, 2) != val(*bit, 2) + val(*bit, 0)) ++statusL;
+      }
+    fabB.setVal(2, 7.);
+    // Linear buffers have the same order for all layouts
+    const Box boxR(IntVect(D_DECL(0, 1, 2)), IntVect(D_DECL(4, 2, 3)));
+    std::vector<Real> bufferS(2*boxR.size());
+    std::vector<Real> bufferB(2*boxR.size());
+    fabS.linearOut(bufferS.data(), boxR, 0, 2);
+    fabB.linearOut(bufferB.data(), boxR, 0, 2);
+    if (bufferS != bufferB) ++statusL;
+    fabA.setVal(0.);
+    fabA.linearIn(bufferB.data(), boxR, 0, 2);
+    for (BoxIterator bit(boxL); bit.ok(); ++bit)
+      {
+        const bool inR = boxR.contains(*bit);
+        if (fabA(*bit, 0) != (inR ? val(*bit, 0) : 0.) ||
+            fabA(*bit, 1) != (inR ? val(*bit, 1) : 0.) ||
+            fabA(*bit, 2) != 0. ||
+            fabB(*bit, 0) != val(*bit, 0) || fabB(*bit, 2) != 7.) ++statusL;
+      }
+    // Copies between regions and components with the same layout
+    AoSoAFab fabC(boxR, 2, 0.);
+    fabC.copy(boxR, 1, fabB, boxR, 0, 1);
+    // Views start on a block
+    AoSoAFab view;
+    const Box boxV(IntVect(D_DECL(3, 0, 2)), IntVect(D_DECL(5, 2, 3)));
+    view.defineView(fabB, boxV);
+    view.setVal(0, 8.);
+    for (BoxIterator bit(boxL); bit.ok(); ++bit)
+      {
+        if (boxR.contains(*bit) &&
+            (fabC(*bit, 0) != 0. || fabC(*bit, 1) != val(*bit, 0)))
+          ++statusL;
+        if (fabB(*bit, 0) != (boxV.contains(*bit) ? 8. : val(*bit, 0)) ||
+            fabB(*bit, 1) != val(*bit, 1)) ++statusL;
+      }
+    if (verbose || statusL != 0)
+      {
+        std::cout << "Layout test " << statLbl[(statusL == 0)] << std::endl;
+      }
+    status += statusL;
+  }
+
+  // Test arithmetic and reductions on a region.  The BaseFab is large
+  // enough to be threaded.
+  {
+    int statusR = 0;
+    const Box boxF(IntVect(D_DECL(-2, -2, -2)), IntVect(D_DECL(41, 41, 9)));
+    const Box boxI(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(39, 39, 7)));
+    const auto val =
+      [](const IntVect& a_iv, const int a_icomp)
+      {
+        return D_TERM(a_iv[0], - 2*a_iv[1], + 3*a_iv[2]) + 0.5*a_icomp;
+      };
+    FArrayBox fabX(boxF, 3, 100.);
+    FArrayBox fabY(boxF, 3, 100.);
+    for (BoxIterator bit(boxI); bit.ok(); ++bit)
+      {
+        for (int ic = 0; ic != 3; ++ic)
+          {
+            fabX(*bit, ic) = val(*bit, ic);
+          }
+      }
+    // Exact references for the interior
+    Real refSum = 0.;
+    Real refNorm1 = 0.;
+    Real refNorm2 = 0.;
+    Real refMin = 1000.;
+    Real refMax = -1000.;
+    for (BoxIterator bit(boxI); bit.ok(); ++bit)
+      {
+        for (int ic = 1; ic != 3; ++ic)
+          {
+            const Real v = val(*bit, ic);
+            refSum += v;
+            refNorm1 += std::fabs(v);
+            refNorm2 += v*v;
+            refMin = std::min(refMin, v);
+            refMax = std::max(refMax, v);
+          }
+      }
+    refNorm2 = std::sqrt(refNorm2);
+    if (fabX.sum(boxI, 1, 3) != refSum ||
+        fabX.norm(boxI, 1, 1, 3) != refNorm1 ||
+        std::fabs(fabX.norm(boxI, 2, 1, 3) - refNorm2) > 1.E-12*refNorm2 ||
+        fabX.norm(boxI, 0, 1, 3) != std::max(-refMin, refMax) ||
+        fabX.min(boxI, 1, 3) != refMin ||
+        fabX.max(boxI, 1, 3) != refMax) ++statusR;
+    // y = 2*(x + 1) + x - 3x/2 = 2 + 3x/2 on components 1 and 2
+    fabY.copy(boxI, fabX);
+    fabY.plus(1., boxI, 1, 3);
+    fabY.mult(2., boxI, 1, 3);
+    fabY.plus(boxI, 1, fabX, 1, 2);
+    fabY.axpy(boxI, 1, -1.5, fabX, 1, 2);
+    // x = 2*x - 0.5*(2 + 3x/2) = 5x/4 - 1
+    fabX.lincomb(boxI, 1, 2., fabX, 1, -0.5, fabY, 1, 2);
+    // Component 0 of x is 1 + x
+    FArrayBox fabOne(boxF, 1, 1.);
+    fabX.plus(boxI, 0, fabOne, 0, 1);
+    fabY.setVal(0, 2.);
+    fabX.mult(boxI, 0, fabY, 0, 1);
+    for (BoxIterator bit(boxF); bit.ok(); ++bit)
+      {
+        const bool inI = boxI.contains(*bit);
+        if (fabX(*bit, 0) != (inI ? 2.*(val(*bit, 0) + 1.) : 100.)) ++statusR;
+        for (int ic = 1; ic != 3; ++ic)
+          {
+            const Real v = val(*bit, ic);
+            if (fabY(*bit, ic) != (inI ? 2. + 1.5*v : 100.) ||
+                fabX(*bit, ic) != (inI ? 1.25*v - 1. : 100.)) ++statusR;
+          }
+      }
+    // Interleaved layouts give the same results
+    BaseFab<Real, LayoutAoSoA<4>> fabB(boxF, 3, 0.);
+    fabB.copy(boxF, 0, fabX, boxF, 0, 3);
+    fabB.plus(-1., boxI, 0, 3);
+    fabX.plus(-1., boxI, 0, 3);
+    if (fabB.sum(boxI, 0, 3) != fabX.sum(boxI, 0, 3) ||
+        fabB.min(boxI, 0, 3) != fabX.min(boxI, 0, 3) ||
+        fabB.norm(boxF, 0, 0, 3) != fabX.norm(boxF, 0, 0, 3)) ++statusR;
+    if (verbose || statusR != 0)
+      {
+        std::cout << "Arithmetic test " << statLbl[(statusR == 0)]
+                  << std::endl;
+      }
+    status += statusR;
+  }
+
 //--Output status
 
   if (verbose)
@@ -0,0 +1,261 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <vector>
+
+#include "BaseFab.H"
+#include "BaseFabMacros.H"
+#include "BoxIterator.H"
+#include "Stopwatch.H"
+
+// Benchmark of BaseFab::copy, linearOut, and linearIn on the face, edge, and
+// corner regions of an exchange.  Results are compared to element-by-element
+// loops and, with -v, times are reported for both.
+
+// Value stored in a cell
+Real val(const IntVect& a_iv, const int a_icomp)
+{
+  return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]) + 1.E6*a_icomp;
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Setup
+
+  const int n = 32;
+  const int nghost = 2;
+  const int ncomp = 5;
+  const int numRep = (verbose) ? 200 : 2;
+  const Box interior(IntVect::Zero, (n - 1)*IntVect::Unit);
+  Box fabBox(interior);
+  fabBox.grow(nghost);
+  FArrayBox fabSrc(fabBox, ncomp);
+  for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+    {
+      for (int ic = 0; ic != ncomp; ++ic)
+        {
+          fabSrc(*bit, ic) = val(*bit, ic);
+        }
+    }
+  FArrayBox fabDst(fabBox, ncomp);
+  FArrayBox fabRef(fabBox, ncomp);
+
+  // Low ghost cells in some directions, and interior in others
+  const auto region =
+    [&](const IntVect& a_ghostDir)
+    {
+      IntVect lo = interior.loVect();
+      IntVect hi = interior.hiVect();
+      for (int dir = 0; dir != g_SpaceDim; ++dir)
+        {
+          if (a_ghostDir[dir])
+            {
+              lo[dir] = fabBox.loVect()[dir];
+              hi[dir] = interior.loVect()[dir] - 1;
+            }
+        }
+      return Box(lo, hi);
+    };
+  struct Region
+  {
+    const char* name;
+    Box box;
+  };
+  IntVect hiZFull = fabBox.hiVect();
+  hiZFull[g_SpaceDim-1] = interior.loVect()[g_SpaceDim-1] - 1;
+  const Box faceZFull(fabBox.loVect(), hiZFull);
+  const std::vector<Region> regions{
+    { "face x", region(IntVect(D_DECL(1, 0, 0))) },
+    { "face y", region(IntVect(D_DECL(0, 1, 0))) },
+    { "face z", region(IntVect(D_DECL(0, 0, 1))) },
+    { "face z (whole planes)", faceZFull },
+    { "edge xy", region(IntVect(D_DECL(1, 1, 0))) },
+    { "edge yz", region(IntVect(D_DECL(0, 1, 1))) },
+    { "corner", region(IntVect::Unit) },
+    { "whole", fabBox } };
+
+  Stopwatch<> timer;
+  if (verbose)
+    {
+      std::cout << "Time per element (ns), fast path vs. element loop, for "
+                << numRep << " repetitions\n";
+      std::cout << std::left << std::setw(24) << "Region"
+                << std::right << std::setw(10) << "cells"
+                << std::setw(18) << "copy"
+                << std::setw(18) << "linearOut"
+                << std::setw(18) << "linearIn" << std::endl;
+    }
+
+//--Test each region
+
+  for (const Region& reg : regions)
+    {
+      const Box& box = reg.box;
+      const size_t numElem = ((size_t)box.size())*ncomp;
+      std::vector<Real> buffer(numElem);
+      std::vector<Real> bufferRef(numElem);
+      double time[3][2];
+
+      // Copy
+      fabDst.setVal(-1.);
+      fabRef.setVal(-1.);
+      fabDst.copy(box, 0, fabSrc, box, 0, ncomp);  // Warm the cache
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          fabDst.copy(box, 0, fabSrc, box, 0, ncomp);
+        }
+      timer.stop();
+      time[0][0] = timer.time();
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          MD_ARRAY(arrSrc, fabSrc);
+          MD_ARRAY(arrRef, fabRef);
+          for (int ic = 0; ic != ncomp; ++ic)
+            {
+              MD_BOXLOOP(box, i)
+                {
+                  arrRef[MD_IX(i, ic)] = arrSrc[MD_IX(i, ic)];
+                }
+            }
+        }
+      timer.stop();
+      time[0][1] = timer.time();
+      int numErr = 0;
+      for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+        {
+          for (int ic = 0; ic != ncomp; ++ic)
+            {
+              if (fabDst(*bit, ic) != fabRef(*bit, ic)) ++numErr;
+            }
+        }
+
+      // Linear out
+      fabSrc.linearOut(buffer.data(), box, 0, ncomp);
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          fabSrc.linearOut(buffer.data(), box, 0, ncomp);
+        }
+      timer.stop();
+      time[1][0] = timer.time();
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          MD_ARRAY(arrSrc, fabSrc);
+          Real* p = bufferRef.data();
+          for (int ic = 0; ic != ncomp; ++ic)
+            {
+              MD_BOXLOOP(box, i)
+                {
+                  *p++ = arrSrc[MD_IX(i, ic)];
+                }
+            }
+        }
+      timer.stop();
+      time[1][1] = timer.time();
+      if (buffer != bufferRef) ++numErr;
+
+      // Linear in
+      fabDst.setVal(-1.);
+      fabRef.setVal(-1.);
+      fabDst.linearIn(buffer.data(), box, 0, ncomp);
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          fabDst.linearIn(buffer.data(), box, 0, ncomp);
+        }
+      timer.stop();
+      time[2][0] = timer.time();
+      timer.reset();
+      timer.start();
+      for (int rep = 0; rep != numRep; ++rep)
+        {
+          MD_ARRAY(arrRef, fabRef);
+          const Real* p = bufferRef.data();
+          for (int ic = 0; ic != ncomp; ++ic)
+            {
+              MD_BOXLOOP(box, i)
+                {
+                  arrRef[MD_IX(i, ic)] = *p++;
+                }
+            }
+        }
+      timer.stop();
+      time[2][1] = timer.time();
+      for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+        {
+          for (int ic = 0; ic != ncomp; ++ic)
+            {
+              const Real expected = box.contains(*bit) ? val(*bit, ic) : -1.;
+              if (fabDst(*bit, ic) != expected ||
+                  fabRef(*bit, ic) != expected) ++numErr;
+            }
+        }
+
+      // Selected components and a shifted destination
+      {
+        const unsigned compFlags = (1 << 1) | (1 << 3);
+        Box dstBox(box);
+        dstBox.shift(IntVect::Unit);
+        dstBox &= fabBox;
+        Box srcBox(dstBox);
+        srcBox.shift(-IntVect::Unit);
+        fabDst.setVal(-1.);
+        fabDst.copy(dstBox, 0, fabSrc, srcBox, 0, ncomp, compFlags);
+        for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+          {
+            for (int ic = 0; ic != ncomp; ++ic)
+              {
+                const Real expected =
+                  (dstBox.contains(*bit) && ((compFlags >> ic) & 1)) ?
+                  val(*bit - IntVect::Unit, ic) : -1.;
+                if (fabDst(*bit, ic) != expected) ++numErr;
+              }
+          }
+      }
+
+      if (verbose)
+        {
+          const double scale = 1.E6/(numRep*numElem);
+          std::cout << std::left << std::setw(24) << reg.name
+                    << std::right << std::setw(10) << box.size();
+          for (int iop = 0; iop != 3; ++iop)
+            {
+              std::cout << std::setw(9) << std::fixed << std::setprecision(2)
+                        << time[iop][0]*scale
+                        << std::setw(9) << time[iop][1]*scale;
+            }
+          std::cout << std::endl;
+          if (numErr != 0)
+            {
+              std::cout << "  errors: " << numErr << std::endl;
+            }
+        }
+      status += numErr;
+    }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testBaseFabCopy";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
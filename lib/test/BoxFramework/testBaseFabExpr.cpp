@@ -0,0 +1,162 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cmath>
+
+#include "BaseFab.H"
+#include "BaseFabExpr.H"
+#include "BaseFabMacros.H"
+#include "BoxIterator.H"
+#include "Stopwatch.H"
+
+// Fused evaluation of BaseFab expressions.  Results are compared to
+// element-by-element loops and, with -v, the time of a fused leapfrog
+// update is compared to the same update as one pass per term.
+
+// Value stored in a cell
+Real val(const IntVect& a_iv, const int a_icomp)
+{
+  return D_TERM(a_iv[0], + 0.5*a_iv[1], - 0.25*a_iv[2]) + 10.*a_icomp;
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Setup
+
+  const int n = 64;
+  const int numRep = (verbose) ? 50 : 1;
+  const Box interior(IntVect::Zero, (n - 1)*IntVect::Unit);
+  Box fabBox(interior);
+  fabBox.grow(1);
+  FArrayBox fabU(fabBox, 2);
+  FArrayBox fabUm1(fabBox, 1);
+  for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+    {
+      fabU(*bit, 0) = val(*bit, 0);
+      fabU(*bit, 1) = val(*bit, 1);
+      fabUm1(*bit, 0) = 0.5*val(*bit, 0);
+    }
+  FArrayBox fabDst(fabBox, 2, -1.);
+  FArrayBox fabRef(fabBox, 2, -1.);
+  const Real factor = 0.125;
+
+//--Tests
+
+  // Operators, scalars, and components
+  {
+    const auto u0 = FabExpr::term(fabU, 0);
+    const auto u1 = FabExpr::term(fabU, 1);
+    FabExpr::assign(fabDst, interior, 1,
+                    -u0/4. + 3.*u1 - (u0*u1 - 1.) + 2.);
+    FabExpr::increment(fabDst, interior, 1, u0 - 1.);
+    int numErr = 0;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        const Real a = val(*bit, 0);
+        const Real b = val(*bit, 1);
+        const Real expected = interior.contains(*bit) ?
+          (-a/4. + 3.*b - (a*b - 1.) + 2.) + (a - 1.) : -1.;
+        if (fabDst(*bit, 1) != expected || fabDst(*bit, 0) != -1.) ++numErr;
+      }
+    if (verbose)
+      {
+        std::cout << "Operator errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Leapfrog update with a Laplacian, fused and as one pass per term
+  {
+    const auto u = FabExpr::term(fabU);
+    const auto d2 =
+      [&u](const int a_dir)
+      {
+        return u.shift(a_dir, 1) - 2.*u + u.shift(a_dir, -1);
+      };
+    Stopwatch<> timer;
+    timer.start();
+    for (int rep = 0; rep != numRep; ++rep)
+      {
+        FabExpr::assign(fabDst, interior, 0,
+                        2.*u - FabExpr::term(fabUm1) +
+                        factor*(D_TERM(d2(0), + d2(1), + d2(2))));
+      }
+    timer.stop();
+    const double timeFused = timer.time();
+    timer.reset();
+    timer.start();
+    for (int rep = 0; rep != numRep; ++rep)
+      {
+        MD_ARRAY_RESTRICT(arrRef, fabRef);
+        MD_ARRAY_RESTRICT(arrU, fabU);
+        MD_ARRAY_RESTRICT(arrUm1, fabUm1);
+        MD_BOXLOOP(interior, i)
+          {
+            arrRef[MD_IX(i, 0)] = 2.*arrU[MD_IX(i, 0)] - arrUm1[MD_IX(i, 0)];
+          }
+        for (int dir = 0; dir != g_SpaceDim; ++dir)
+          {
+            const int MD_ID(o, dir);
+            MD_BOXLOOP(interior, i)
+              {
+                arrRef[MD_IX(i, 0)] += factor*(arrU[MD_OFFSETIX(i,+,o, 0)] -
+                                               2.*arrU[MD_IX(i, 0)] +
+                                               arrU[MD_OFFSETIX(i,-,o, 0)]);
+              }
+          }
+      }
+    timer.stop();
+    const double timePasses = timer.time();
+    int numErr = 0;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        if (std::fabs(fabDst(*bit, 0) - fabRef(*bit, 0)) >
+            1.E-12*std::fabs(fabRef(*bit, 0))) ++numErr;
+      }
+    if (verbose)
+      {
+        std::cout << "Leapfrog errors: " << numErr << std::endl;
+        std::cout << "Time (ms) fused: " << timeFused/numRep
+                  << ", one pass per term: " << timePasses/numRep
+                  << std::endl;
+      }
+    status += numErr;
+  }
+
+  // The destination may appear unshifted
+  {
+    fabDst.copy(fabBox, fabU);
+    const auto d = FabExpr::term(fabDst, 1);
+    FabExpr::assign(fabDst, interior, 1, d*d - d);
+    int numErr = 0;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        const Real b = val(*bit, 1);
+        const Real expected = interior.contains(*bit) ? b*b - b : b;
+        if (fabDst(*bit, 1) != expected) ++numErr;
+      }
+    if (verbose)
+      {
+        std::cout << "In-place errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testBaseFabExpr";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstddef>
+#include <climits>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "BaseFab.H"
+#include "BaseFabMacros.H"
+
+// Sizes and linear offsets of BaseFabs with more than 2^31 elements.  The
+// memory is reserved but only the pages that are indexed are touched.  On
+// a node with enough physical memory, a large BaseFab is also allocated
+// and assigned.  With -v, the sizes and the tests that ran are reported.
+
+// Cells in each direction (each component of the box or, in 1-D, all
+// components together, have more than 2^31 elements)
+constexpr int c_n = D_SELECT(1 << 30, 1 << 16, 1300);
+constexpr int c_ncomp = 3;
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  const Box box(-IntVect::Unit, (c_n - 2)*IntVect::Unit);
+  const std::ptrdiff_t numCell = D_TERM((std::ptrdiff_t)c_n, *c_n, *c_n);
+  const std::ptrdiff_t numElem = c_ncomp*numCell;
+  if (box.size() != numCell || numElem <= INT_MAX) ++status;
+
+  // Indexing an aliased BaseFab in reserved (untouched) memory
+  {
+    int numErr = 0;
+    const size_t bytes = BaseFab<char>::aliasSize(box, c_ncomp);
+    void *const addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                            -1, 0);
+    if (addr == MAP_FAILED)
+      {
+        if (verbose)
+          {
+            std::cout << "Unable to reserve " << bytes
+                      << " bytes (aliased tests skipped)" << std::endl;
+          }
+      }
+    else
+      {
+        BaseFab<char> fab(box, c_ncomp, static_cast<char*>(addr));
+        const IntVect& lo = box.loVect();
+        const IntVect& hi = box.hiVect();
+        const int D_DECL(l0 = lo[0], l1 = lo[1], l2 = lo[2]);
+        const int D_DECL(h0 = hi[0], h1 = hi[1], h2 = hi[2]);
+        if (bytes != (size_t)numElem) ++numErr;
+        if (fab.size() != numElem) ++numErr;
+        if (fab.getComponentStride() != numCell) ++numErr;
+        if (fab.index(hi) != numCell - 1) ++numErr;
+        if (&fab(hi, c_ncomp-1) - &fab(lo, 0) != numElem - 1) ++numErr;
+        if (fab.dataPtr(c_ncomp-1) - fab.dataPtr(0) != (c_ncomp-1)*numCell)
+          ++numErr;
+        fab(lo, 0) = 1;
+        fab(hi, 0) = 2;
+        fab(hi, c_ncomp-1) = 3;
+        // Multi-dimensional arrays
+        {
+          MD_ARRAY_RESTRICT(arr, fab);
+          if (arr[MD_IX(l, 0)] != 1 || arr[MD_IX(h, 0)] != 2 ||
+              arr[MD_IX(h, c_ncomp-1)] != 3) ++numErr;
+          MD_LAYOUT_ARRAY(larr, fab);
+          if (larr[MD_IX(l, 0)] != 1 || larr[MD_IX(h, 0)] != 2 ||
+              larr[MD_IX(h, c_ncomp-1)] != 3) ++numErr;
+        }
+        // Copies and linear buffers of the last rows in x (long runs)
+        {
+          IntVect cornerLo(hi - IntVect::Unit);
+          cornerLo[0] = D_SELECT(hi[0] - 2047, lo[0], lo[0]);
+          const Box corner(cornerLo, hi);
+          BaseFab<char> small(corner, c_ncomp);
+          small.setVal(5);
+          fab.copy(corner, small);
+          std::vector<char> buffer(c_ncomp*corner.size());
+          fab.linearOut(buffer.data(), corner, 0, c_ncomp);
+          for (const char c : buffer)
+            {
+              if (c != 5) ++numErr;
+            }
+          buffer.back() = 6;
+          fab.linearIn(buffer.data(), corner, 0, c_ncomp);
+          if (fab(hi, c_ncomp-1) != 6 || fab(lo, 0) != 1) ++numErr;
+        }
+        munmap(addr, bytes);
+        if (verbose)
+          {
+            std::cout << "Aliased " << numElem << " elements ("
+                      << numCell << " cells)\n"
+                      << "Aliased indexing errors: " << numErr << std::endl;
+          }
+      }
+    status += numErr;
+  }
+
+  // Allocating and assigning on a big-memory node
+  {
+    int numErr = 0;
+    const long numPage = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (numPage > 0 && pageSize > 0 &&
+        (double)numPage*pageSize > 2.*numElem)
+      {
+        BaseFab<char> fab(box, c_ncomp);
+        fab.setVal(7);
+        fab(box.hiVect(), 2) = 8;
+        const IntVect& lo = box.loVect();
+        const IntVect& hi = box.hiVect();
+        const int D_DECL(l0 = lo[0], l1 = lo[1], l2 = lo[2]);
+        const int D_DECL(h0 = hi[0], h1 = hi[1], h2 = hi[2]);
+        MD_ARRAY_RESTRICT(arr, fab);
+        for (int c = 0; c != c_ncomp; ++c)
+          {
+            if (arr[MD_IX(l, c)] != 7 || arr[MD_IX(h, c)] != 7 + (c == 2))
+              ++numErr;
+          }
+        if (verbose)
+          {
+            std::cout << "Allocated " << fab.sizeBytes() << " bytes\n"
+                      << "Allocated indexing errors: " << numErr
+                      << std::endl;
+          }
+      }
+    else if (verbose)
+      {
+        std::cout << "Insufficient memory to allocate " << numElem
+                  << " bytes (allocated tests skipped)" << std::endl;
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testBaseFabLarge";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+#include "BaseFab.H"
+#include "BaseFabExpr.H"
+#include "BaseFabStorage.H"
+#include "BoxIterator.H"
+
+// Reduced-precision storage (float and BFloat16) with arithmetic in Real.
+// The accuracy of a diffusion problem is compared to storage in Real and,
+// with -v, the errors and bytes stored are reported.
+
+// Initial value in a cell
+Real val(const IntVect& a_iv)
+{
+  return std::sin(0.2*a_iv[0])*std::cos(0.3*a_iv[1]) + 2. +
+    D_SELECT(0., 0., 0.1*a_iv[2]);
+}
+
+// Explicit diffusion in the interior (ghost cells are fixed)
+template <typename S>
+void diffuse(BaseFab<S>& a_u, const Box& a_interior, const int a_numStep)
+{
+  BaseFab<S> tmp(a_u.box(), 1);
+  tmp.copy(a_u.box(), a_u);
+  const auto u = FabExpr::term(a_u);
+  const auto d2 =
+    [&u](const int a_dir)
+    {
+      return u.shift(a_dir, 1) - 2.*u + u.shift(a_dir, -1);
+    };
+  for (int step = 0; step != a_numStep; ++step)
+    {
+      FabExpr::assign(tmp, a_interior, 0,
+                      u + (0.1/g_SpaceDim)*(D_TERM(d2(0), + d2(1), + d2(2))));
+      a_u.copy(a_interior, 0, tmp, a_interior, 0, 1);
+    }
+}
+
+// Relative 2-norm of the difference from the Real solution
+template <typename S>
+Real relError(const BaseFab<S>& a_u, const FArrayBox& a_uRef, const Box& a_box)
+{
+  FArrayBox diff(a_box, 1);
+  FabExpr::assign(diff, a_box, 0, FabExpr::term(a_u) - FabExpr::term(a_uRef));
+  return diff.norm(a_box, 2, 0, 1)/a_uRef.norm(a_box, 2, 0, 1);
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  // Conversion of BFloat16 (7 fraction bits, round to nearest even)
+  {
+    int numErr = 0;
+    if (sizeof(BFloat16) != 2) ++numErr;
+    if (Real(BFloat16()) != 0.) ++numErr;
+    const Real exact[] = { 1., -2.5, 0.15625, 65536., -0.75 };
+    for (const Real x : exact)
+      {
+        if (Real(BFloat16(x)) != Real(static_cast<float>(x)) ||
+            Real(BFloat16(x)) != x) ++numErr;
+      }
+    // Relative error is at most half of 2^-7
+    for (int i = 1; i != 1000; ++i)
+      {
+        const Real x = std::exp(0.05*i - 20.);
+        if (std::fabs(Real(BFloat16(x)) - x) > x/256.) ++numErr;
+      }
+    const Real ulp = 1./128.;
+    if (Real(BFloat16(1. + 0.5*ulp)) != 1.) ++numErr;            // Tie, even
+    if (Real(BFloat16(1. + 1.5*ulp)) != 1. + 2.*ulp) ++numErr;   // Tie, even
+    if (Real(BFloat16(1. + 0.6*ulp)) != 1. + ulp) ++numErr;
+    if (Real(BFloat16(-1. - 0.4*ulp)) != -1.) ++numErr;
+    if (!std::isnan(Real(BFloat16(std::nan(""))))) ++numErr;
+    BFloat16 acc(1.);
+    acc += 2.;
+    acc *= 3.;
+    if (Real(acc) != 9.) ++numErr;
+    if (verbose)
+      {
+        std::cout << "BFloat16 conversion errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  const int n = 32;
+  const Box interior(IntVect::Zero, (n - 1)*IntVect::Unit);
+  Box fabBox(interior);
+  fabBox.grow(1);
+
+  // Accuracy of diffusion with storage of Real, float, and BFloat16
+  {
+    const int numStep = 20;
+    FArrayBox uReal(fabBox, 1);
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        uReal(*bit, 0) = val(*bit);
+      }
+    // Converting assignment from Real
+    BaseFab<float> uFloat(fabBox, 1);
+    FabExpr::assign(uFloat, fabBox, 0, FabExpr::term(uReal));
+    BaseFab<BFloat16> uHalf(fabBox, 1);
+    FabExpr::assign(uHalf, fabBox, 0, FabExpr::term(uReal));
+    int numErr = 0;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        if (uFloat(*bit, 0) != static_cast<float>(uReal(*bit, 0)) ||
+            Real(uHalf(*bit, 0)) != Real(BFloat16(uReal(*bit, 0)))) ++numErr;
+      }
+    diffuse(uReal, interior, numStep);
+    diffuse(uFloat, interior, numStep);
+    diffuse(uHalf, interior, numStep);
+    const Real errFloat = relError(uFloat, uReal, interior);
+    const Real errHalf = relError(uHalf, uReal, interior);
+    // Float is near its rounding error.  BFloat16 loses updates smaller
+    // than half of its 2^-7 precision, so its error grows with the steps.
+    if (!(errFloat < 1.E-6) || !(errHalf < 3.E-2) || !(errFloat < errHalf))
+      ++numErr;
+    if (uFloat.sizeBytes() != uReal.sizeBytes()/2 ||
+        uHalf.sizeBytes() != uReal.sizeBytes()/4) ++numErr;
+    if (verbose)
+      {
+        std::cout << "Relative error after " << numStep
+                  << " diffusion steps (bytes stored)\n"
+                  << "  float   : " << errFloat << " ("
+                  << uFloat.sizeBytes() << ")\n"
+                  << "  BFloat16: " << errHalf << " ("
+                  << uHalf.sizeBytes() << ")\n"
+                  << "  Real    : " << 0. << " ("
+                  << uReal.sizeBytes() << ")" << std::endl;
+        std::cout << "Diffusion errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Arithmetic and reductions are computed in Real
+  {
+    int numErr = 0;
+    BaseFab<BFloat16> fab(fabBox, 2);
+    fab.setVal(BFloat16(1.));
+    // Summing 1s in BFloat16 would stop at 256
+    if (fab.sum(fabBox, 0, 2) != 2.*fabBox.size()) ++numErr;
+    fab.mult(0.5, interior, 1, 2);
+    fab.plus(1./1024., interior, 1, 2);
+    // 0.5 + 1/1024 rounds to 0.5 when stored
+    if (fab.max(interior, 1, 2) != 0.5 || fab.min(fabBox, 0, 2) != 0.5)
+      ++numErr;
+    fab.axpy(interior, 0, 0.25, fab, 1, 1);
+    if (Real(fab(IntVect::Zero, 0)) != 1.125 ||
+        fab.norm(fabBox, 0, 0, 1) != 1.125) ++numErr;
+    BaseFab<float> fabF(fabBox, 1);
+    fabF.setVal(0.1f);
+    if (std::fabs(fabF.sum(fabBox, 0, 1) -
+                  fabBox.size()*Real(0.1f)) > 1.E-9*fabBox.size()) ++numErr;
+    if (verbose)
+      {
+        std::cout << "Arithmetic errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Linear buffers hold the stored bytes
+  {
+    int numErr = 0;
+    BaseFab<BFloat16> fabA(fabBox, 2);
+    int idx = 0;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit, ++idx)
+      {
+        fabA(*bit, 0) = 0.01*idx;
+        fabA(*bit, 1) = -0.01*idx;
+      }
+    std::vector<char> buffer(2*interior.size()*sizeof(BFloat16));
+    fabA.linearOut(buffer.data(), interior, 0, 2);
+    BaseFab<BFloat16> fabB(fabBox, 2);
+    fabB.setVal(BFloat16(0.));
+    fabB.linearIn(buffer.data(), interior, 0, 2);
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        for (int c = 0; c != 2; ++c)
+          {
+            const uint16_t expected = (interior.contains(*bit)) ?
+              fabA(*bit, c).bits() : BFloat16(0.).bits();
+            if (fabB(*bit, c).bits() != expected) ++numErr;
+          }
+      }
+    if (verbose)
+      {
+        std::cout << "Linear buffer errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testBaseFabStorage";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
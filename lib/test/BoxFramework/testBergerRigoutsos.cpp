@@ -0,0 +1,190 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <vector>
+
+#include "BaseFab.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "BergerRigoutsos.H"
+
+// Number of errors in a set of boxes clustering the tags in a BaseFab
+int checkBoxes(const BaseFab<bool>&    a_tags,
+               const std::vector<Box>& a_boxes,
+               const Real              a_fillRatio,
+               const IntVect&          a_maxBoxSize)
+{
+  int numErr = 0;
+  BaseFab<int> cover(a_tags.box(), 1, 0);
+  for (const Box& box : a_boxes)
+    {
+      if (!a_tags.box().contains(box)) { ++numErr; continue; }
+      int numTag = 0;
+      for (BoxIterator bit(box); bit.ok(); ++bit)
+        {
+          ++cover(*bit, 0);
+          if (a_tags(*bit, 0)) ++numTag;
+        }
+      // Efficient
+      if (numTag < a_fillRatio*box.size()) ++numErr;
+      // Small enough
+      for (int dir = 0; dir != g_SpaceDim; ++dir)
+        {
+          if (a_maxBoxSize[dir] > 0 && box.dimensions()[dir] > a_maxBoxSize[dir])
+            ++numErr;
+        }
+    }
+  // Disjoint and covering all tags
+  for (BoxIterator bit(a_tags.box()); bit.ok(); ++bit)
+    {
+      if (cover(*bit, 0) > 1) ++numErr;
+      if (a_tags(*bit, 0) && cover(*bit, 0) != 1) ++numErr;
+    }
+  return numErr;
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  const Box domain(IntVect::Zero, IntVect(D_DECL(15, 15, 3)));
+
+  // Two separate blocks of tags are found exactly (by a hole in the
+  // signature)
+  {
+    const Box blockA(IntVect(D_DECL(2, 2, 0)), IntVect(D_DECL(5, 5, 3)));
+    const Box blockB(IntVect(D_DECL(10, 8, 0)), IntVect(D_DECL(13, 11, 3)));
+    BaseFab<bool> tags(domain, 1, false);
+    for (BoxIterator bit(blockA); bit.ok(); ++bit) tags(*bit, 0) = true;
+    for (BoxIterator bit(blockB); bit.ok(); ++bit) tags(*bit, 0) = true;
+    BergerRigoutsos br;
+    std::vector<Box> boxes;
+    br.makeBoxes(tags, boxes);
+    if (boxes.size() != 2) ++status;
+    for (const Box& box : boxes)
+      {
+        if (box != blockA && box != blockB) ++status;
+      }
+    status += checkBoxes(tags, boxes, br.fillRatio(), br.maxBoxSize());
+    if (verbose)
+      {
+        for (const Box& box : boxes) std::cout << "Block: " << box << std::endl;
+      }
+  }
+
+  // An L shape is split at the inflection of the signature
+  {
+    BaseFab<bool> tags(domain, 1, false);
+    for (BoxIterator bit(domain); bit.ok(); ++bit)
+      {
+        const IntVect& iv = *bit;
+        if ((iv[0] < 12 && iv[1] < 3) || (iv[0] < 3 && iv[1] < 12))
+          tags(iv, 0) = true;
+      }
+    BergerRigoutsos br(0.9, IntVect::Zero);
+    std::vector<Box> boxes;
+    br.makeBoxes(tags, boxes);
+    if (boxes.size() != 2) ++status;
+    status += checkBoxes(tags, boxes, br.fillRatio(), br.maxBoxSize());
+    if (verbose)
+      {
+        for (const Box& box : boxes) std::cout << "L: " << box << std::endl;
+      }
+  }
+
+  // A disk of tags with a maximum box size
+  {
+    BaseFab<bool> tags(domain, 1, false);
+    int numTag = 0;
+    for (BoxIterator bit(domain); bit.ok(); ++bit)
+      {
+        const IntVect& iv = *bit;
+        const int r2 = (iv[0] - 7)*(iv[0] - 7) + (iv[1] - 8)*(iv[1] - 8);
+        if (r2 <= 36)
+          {
+            tags(iv, 0) = true;
+            ++numTag;
+          }
+      }
+    BergerRigoutsos br(0.7, 8*IntVect::Unit);
+    std::vector<Box> boxes;
+    br.makeBoxes(tags, boxes);
+    status += checkBoxes(tags, boxes, br.fillRatio(), br.maxBoxSize());
+    int numCell = 0;
+    for (const Box& box : boxes) numCell += box.size();
+    // Much less than the bounding box of the disk
+    if (numCell >= (13*13*(D_TERM(1, *1, *4)))) ++status;
+    if (verbose)
+      {
+        std::cout << "Disk: " << boxes.size() << " boxes, " << numCell
+                  << " cells for " << numTag << " tags" << std::endl;
+      }
+
+    // Fully tagged domain is chopped into boxes of the maximum size
+    BaseFab<bool> all(domain, 1, true);
+    BergerRigoutsos brMax(0.7, IntVect(D_DECL(4, 4, 4)));
+    brMax.makeBoxes(all, boxes);
+    if (boxes.size() != 16) ++status;
+    status += checkBoxes(all, boxes, brMax.fillRatio(), brMax.maxBoxSize());
+  }
+
+  // Layout from tags in a LevelData
+  {
+    DisjointBoxLayout dbl(domain, 4*IntVect::Unit);
+    LevelData<BaseFab<bool>> lvlTags(dbl, 1, 1);
+    lvlTags.setVal(false);
+    BaseFab<bool> tags(domain, 1, false);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+          {
+            const IntVect& iv = *bit;
+            if (iv[0] + iv[1] >= 12 && iv[0] + iv[1] <= 16)
+              {
+                lvlTags[dit](iv, 0) = true;
+                tags(iv, 0) = true;
+              }
+          }
+      }
+    BergerRigoutsos br(0.8, 8*IntVect::Unit);
+    DisjointBoxLayout newDbl;
+    br.makeLayout(lvlTags, newDbl);
+    if (newDbl.problemDomain() != domain) ++status;
+    if (newDbl.isLattice()) ++status;
+    if (newDbl.size() == 0 || newDbl.localSize() != newDbl.size()) ++status;
+    std::vector<Box> boxes;
+    for (int idx = 0; idx != newDbl.size(); ++idx)
+      {
+        boxes.push_back(newDbl.getLinear(idx).box);
+      }
+    status += checkBoxes(tags, boxes, br.fillRatio(), br.maxBoxSize());
+    // Same boxes from the BaseFab
+    std::vector<Box> boxesFab;
+    br.makeBoxes(tags, boxesFab);
+    if (boxesFab.size() != boxes.size()) ++status;
+    if (verbose)
+      {
+        std::cout << "Diagonal band: " << boxes.size() << " boxes"
+                  << std::endl;
+      }
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testBergerRigoutsos";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -1,8 +1,11 @@
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <sstream>
+#include <vector>
 
 #include "DisjointBoxLayout.H"
+#include "LayoutIterator.H"
 
 int main(const int argc, const char* argv[])
 {
@@ -66,6 +69,152 @@ int main(const int argc, const char* argv[])
     D_TERM(},},})
   }
 
+  // Default lattices compute the boxes.  The same boxes given as a list are
+  // stored.
+  {
+    if (!dbl1.isImplicit()) {std::cout << "implicit" << std::endl; ++status;};
+    std::vector<Box> boxes(dbl1.size());
+    for (int linIdxBox = 0; linIdxBox != dbl1.size(); ++linIdxBox)
+      {
+        boxes[linIdxBox] = dbl1.getLinear(linIdxBox).box;
+      }
+    DisjointBoxLayout dblList(domain, boxes, std::vector<int>(boxes.size(), 0));
+    if (dblList.isImplicit()) {std::cout << "explicit" << std::endl; ++status;};
+    for (LayoutIterator lit(dbl1); lit.ok(); ++lit)
+      {
+        if (dbl1[lit] != dblList.getLinear((*lit).globalIndex()).box) {std::cout << "implicitbox" << std::endl; ++status;};
+        if (dbl1.proc(lit) != dblList.getLinear((*lit).globalIndex()).proc) {std::cout << "implicitproc" << std::endl; ++status;};
+      }
+    DisjointBoxLayout dblCopy;
+    dblCopy.defineDeepCopy(dbl1);
+    if (!dblCopy.isImplicit() || dblCopy.tag() == dbl1.tag()) {std::cout << "implicitcopy" << std::endl; ++status;};
+  }
+
+  // Statistics (all boxes are on one node)
+  if (DisjointBoxLayout::numProc() == 1)
+    {
+      DisjointBoxLayout::Statistics stats;
+      dbl1.statistics(stats);
+      if (stats.numBoxNode != std::vector<int>{ dbl1.size() }) {std::cout << "statsbox" << std::endl; ++status;};
+      if (stats.numCellNode[0] != domain.size()) {std::cout << "statscell" << std::endl; ++status;};
+      // Each of the 2^(D-1) rows of boxes in each direction has one face
+      const int numFaceCell =
+        g_SpaceDim*(1 << (g_SpaceDim - 1))*(5*IntVect::Unit).product()/5;
+      if (stats.numFaceCellProc != numFaceCell) {std::cout << "statsface: " << stats.numFaceCellProc << std::endl; ++status;};
+      if (stats.numFaceCellNode != 0 || stats.numFaceCellInterNode != 0) {std::cout << "statsnode" << std::endl; ++status;};
+    }
+
+  // An explicit list of boxes that does not form a lattice
+  {
+    const Box domain2(IntVect::Zero, IntVect(D_DECL(9, 5, 3)));
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(3, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(9, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(0, 3, 0)), IntVect(D_DECL(6, 5, 3)));
+    boxes.emplace_back(IntVect(D_DECL(7, 3, 0)), IntVect(D_DECL(9, 5, 3)));
+    DisjointBoxLayout dbl2(domain2, boxes, std::vector<int>(4, 0));
+    if (dbl2.isLattice()) {std::cout << "islattice" << std::endl; ++status;};
+    if (!dbl1.isLattice()) {std::cout << "notlattice" << std::endl; ++status;};
+    if (dbl2.size() != 4) {std::cout << "listsize" << std::endl; ++status;};
+    if (dbl2.problemDomain() != domain2) {std::cout << "listdomain" << std::endl; ++status;};
+    for (int linIdxBox = 0; linIdxBox != 4; ++linIdxBox)
+      {
+        if (dbl2.getLinear(linIdxBox).box != boxes[linIdxBox]) {std::cout << "listbox" << std::endl; ++status;};
+      }
+    // Intersecting boxes are returned in order of global index
+    std::vector<int> found;
+    dbl2.findIntersecting(Box(IntVect(D_DECL(3, 2, 0)), IntVect(D_DECL(7, 3, 0))), found);
+    if (found != std::vector<int>{ 0, 1, 2, 3 }) {std::cout << "intersect1" << std::endl; ++status;};
+    dbl2.findIntersecting(Box(IntVect(D_DECL(7, 0, 1)), IntVect(D_DECL(8, 3, 1))), found);
+    if (found != std::vector<int>{ 1, 3 }) {std::cout << "intersect2" << std::endl; ++status;};
+    dbl2.findIntersecting(Box(IntVect(D_DECL(10, 0, 0)), IntVect(D_DECL(11, 5, 3))), found);
+    if (!found.empty()) {std::cout << "intersect3" << std::endl; ++status;};
+  }
+
+  // Layouts restored from a binary cache
+  {
+    std::stringstream cache;
+    dbl1.writeBinary(cache);
+    const Box domain2(IntVect::Zero, IntVect(D_DECL(9, 5, 3)));
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(9, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(3, 5, 3)));
+    DisjointBoxLayout dbl2(domain2, boxes, std::vector<int>(2, 0));
+    dbl2.writeBinary(cache);
+    // The lattice is keyed by domain and box size
+    std::stringstream cacheCopy(cache.str());
+    DisjointBoxLayout dblR;
+    if (dblR.readBinary(cacheCopy, domain, 4*IntVect::Unit) != 2) {std::cout << "cachekey" << std::endl; ++status;};
+    DisjointBoxLayout dbl3;
+    if (dbl3.readBinary(cache, domain, 5*IntVect::Unit) != 0) {std::cout << "cachelattice" << std::endl; ++status;};
+    if (!dbl3.isImplicit() || dbl3.size() != dbl1.size() || dbl3.localSize() != dbl1.localSize()) {std::cout << "cachelattice" << std::endl; ++status;};
+    for (int idx = 0; idx != dbl1.size(); ++idx)
+      {
+        if (dbl3.getLinear(idx).box != dbl1.getLinear(idx).box) {std::cout << "cachelattice" << std::endl; ++status;};
+      }
+    DisjointBoxLayout dbl4;
+    if (dbl4.readBinary(cache, domain2, IntVect::Zero) != 0) {std::cout << "cachelist" << std::endl; ++status;};
+    if (dbl4.isLattice() || dbl4.size() != 2 || dbl4.localSize() != 2) {std::cout << "cachelist" << std::endl; ++status;};
+    for (int idx = 0; idx != 2; ++idx)
+      {
+        if (dbl4.getLinear(idx).box != boxes[idx]) {std::cout << "cachelist" << std::endl; ++status;};
+      }
+    std::vector<int> found;
+    dbl4.findIntersecting(Box(IntVect(D_DECL(3, 1, 0)), IntVect(D_DECL(4, 1, 0))), found);
+    if (found != std::vector<int>{ 0, 1 }) {std::cout << "cachelist" << std::endl; ++status;};
+    // Nothing left in the stream
+    if (dbl4.readBinary(cache, domain2, IntVect::Zero) != 1) {std::cout << "cacheend" << std::endl; ++status;};
+  }
+
+  // Intersections in a larger layout with boxes of many sizes (that do not
+  // cover the domain) are the same as found by brute force.  The lattice
+  // is also tested.
+  {
+    const Box domain3(IntVect::Zero, IntVect(D_DECL(63, 47, 11)));
+    const int widths[] = { 3, 7, 2, 11, 5 };
+    const int heights[] = { 4, 9, 1, 6 };
+    std::vector<Box> boxes;
+    int c = 0;
+    for (int y = 0, iy = 0; y <= 47; y += heights[iy++ % 4])
+      {
+        for (int x = 0; x <= 63; x += widths[c++ % 5])
+          {
+            if (c % 7 == 0) continue;  // Leave some holes
+            IntVect lo(D_DECL(x, y, 0));
+            IntVect hi(D_DECL(x + widths[c % 5] - 1, y + heights[iy % 4] - 1,
+                              11));
+            hi.min(domain3.hiVect());
+            boxes.emplace_back(lo, hi);
+          }
+      }
+    std::vector<int> procs(boxes.size(), 0);
+    DisjointBoxLayout dbl3(domain3, boxes, procs);
+    const DisjointBoxLayout* dbls[] = { &dbl1, &dbl3 };
+    std::vector<int> found;
+    std::vector<int> expected;
+    for (const DisjointBoxLayout* dbl : dbls)
+      {
+        int numErr = 0;
+        for (int q = 0; q != 200; ++q)
+          {
+            const IntVect lo(D_DECL((q*37) % 70 - 3, (q*23) % 52 - 2,
+                                    (q*5) % 14 - 1));
+            const IntVect hi(lo + IntVect(D_DECL(q % 9, (q*3) % 11, q % 4)));
+            const Box region(lo, hi);
+            dbl->findIntersecting(region, found);
+            expected.clear();
+            for (int idx = 0; idx != dbl->size(); ++idx)
+              {
+                Box test = dbl->getLinear(idx).box;
+                test &= region;
+                if (!test.isEmpty()) expected.push_back(idx);
+              }
+            if (found != expected) ++numErr;
+          }
+        if (numErr) {std::cout << "intersectbins: " << numErr << std::endl; ++status;};
+      }
+  }
+
 //--Serial testing
 
   if (DisjointBoxLayout::numProc() == 1)
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 #include "LayoutIterator.H"
 
@@ -179,6 +180,76 @@ int main(const int argc, const char* argv[])
           }
       }
   }
+
+//--Test neighbors in a layout that is not a lattice
+
+  {
+    const Box domain2(IntVect::Zero, IntVect(D_DECL(9, 5, 3)));
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(3, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(9, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(0, 3, 0)), IntVect(D_DECL(6, 5, 3)));
+    boxes.emplace_back(IntVect(D_DECL(7, 3, 0)), IntVect(D_DECL(9, 5, 3)));
+    DisjointBoxLayout dbl2(domain2, boxes, std::vector<int>(4, 0));
+    const int numNbr[] = { 2, 3, 3, 2 };
+    const IntVect domainDim = domain2.dimensions();
+    for (LayoutIterator lit(dbl2); lit.ok(); ++lit)
+      {
+        Box grownBox = dbl2[lit];
+        grownBox.grow(1);
+        int cNbr = 0;
+        for (NeighborIterator nbrit(lit); nbrit.ok(); ++nbrit, ++cNbr)
+          {
+            Box region(grownBox);
+            region &= dbl2[nbrit];
+            if (region.isEmpty() || dbl2[nbrit] == dbl2[lit]) ++status;
+            // The direction points from the box to the neighbor
+            Box shifted(dbl2[lit]);
+            shifted.shift(nbrit.nbrDir());
+            shifted &= dbl2[nbrit];
+            if (shifted.isEmpty()) ++status;
+          }
+        if (cNbr != numNbr[(*lit).globalIndex()]) ++status;
+
+        // Periodic in x and y.  Count, by brute force, the periodic images
+        // touching the box
+        int numPer = 0;
+        for (LayoutIterator lit2(dbl2); lit2.ok(); ++lit2)
+          {
+            for (BoxIterator sit(Box(IntVect(D_DECL(-1, -1, 0)),
+                                     IntVect(D_DECL(1, 1, 0))));
+                 sit.ok(); ++sit)
+              {
+                if (*sit == IntVect::Zero) continue;
+                Box image(dbl2[lit2]);
+                image.shift((*sit)*domainDim);
+                image &= grownBox;
+                if (!image.isEmpty()) ++numPer;
+              }
+          }
+        int cPer = 0;
+        for (PeriodicIterator perit(lit, 0, PeriodicX | PeriodicY);
+             perit.ok(); ++perit, ++cPer)
+          {
+            Box image(dbl2[perit]);
+            image.shift(perit.shift());
+            if (domain2.contains(image)) ++status;
+            Box region(grownBox);
+            region &= image;
+            if (region.isEmpty()) ++status;
+            Box shifted(dbl2[lit]);
+            shifted.shift(perit.nbrDir());
+            shifted &= image;
+            if (shifted.isEmpty()) ++status;
+          }
+        if (cPer != numPer) ++status;
+        if (verbose)
+          {
+            std::cout << "Box " << dbl2[lit] << ": " << cNbr << " neighbors, "
+                      << cPer << " periodic neighbors" << std::endl;
+          }
+      }
+  }
 #endif
 //--Output status
 
@@ -1,5 +1,11 @@
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 #include "BaseFab.H"
 #include "DisjointBoxLayout.H"
@@ -167,6 +173,528 @@ int main(const int argc, const char* argv[])
           }
       }
   }
+
+  // Test allocation of all boxes from one slab.  The BaseFabs are aligned,
+  // ordered, and disjoint in the slab and behave as separately allocated
+  // BaseFabs in exchange.
+  {
+    if (verbose) std::cout << "Testing slab allocation\n";
+    using AllocBy = LevelData<BaseFab<Real> >::AllocBy;
+    LevelData<BaseFab<Real> > slab(dbl, 2, 1, AllocBy::slab);
+    if (slab.allocBy() != AllocBy::slab || slab.slabPtr() == nullptr)
+      ++status;
+    const Real* slabEnd = slab.slabPtr() + slab.slabSize();
+    const Real* prevEnd = slab.slabPtr();
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = slab[dit];
+        if (fab.dataPtr() < prevEnd) ++status;
+        if (reinterpret_cast<std::uintptr_t>(fab.dataPtr()) %
+            BaseFab<Real>::s_alignment != 0) ++status;
+        prevEnd = fab.dataPtr() + fab.size();
+        if (prevEnd > slabEnd) ++status;
+      }
+    slab.setVal(-1.);
+    for (int c = 0; c != numBox; ++c)
+      {
+        const BaseFab<Real>& fab = slab.getLinear(c);
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (fab(*bit, 0) != -1. || fab(*bit, 1) != -1.) ++status;
+          }
+      }
+    // Same results as the separately allocated lvldata after exchange
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        slab[dit].copy(dbl[dit], lvldata[dit]);
+      }
+    Copier copierS;
+    copierS.defineExchangeLD<BaseFab<Real> >(slab);
+    slab.exchange(copierS);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = slab[dit];
+        const BaseFab<Real>& fabRef = lvldata[dit];
+        if (fab.box() != fabRef.box()) ++status;
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (!domain.contains(*bit)) continue;
+            if (fab(*bit, 0) != fabRef(*bit, 0) ||
+                fab(*bit, 1) != fabRef(*bit, 1)) ++status;
+          }
+      }
+    // Redefining with separate allocations releases the slab
+    slab.define(dbl, 1, 0);
+    if (slab.allocBy() != AllocBy::box || slab.slabPtr() != nullptr ||
+        slab.slabSize() != 0) ++status;
+    // Interleaved layouts are also exchanged from a slab
+    using AoSoAFab = BaseFab<Real, LayoutAoSoA<4>>;
+    LevelData<AoSoAFab> slabL(dbl, 2, 1, LevelData<AoSoAFab>::AllocBy::slab);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        slabL[dit].copy(dbl[dit], 0, lvldata[dit], dbl[dit], 0, 2);
+      }
+    Copier copierL;
+    copierL.defineExchangeLD<AoSoAFab>(slabL);
+    slabL.exchange(copierL);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        const AoSoAFab& fab = slabL[dit];
+        const BaseFab<Real>& fabRef = lvldata[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (!domain.contains(*bit)) continue;
+            if (fab(*bit, 0) != fabRef(*bit, 0) ||
+                fab(*bit, 1) != fabRef(*bit, 1)) ++status;
+          }
+      }
+  }
+
+  // Test allocation from a file on scratch.  The data starts at zero,
+  // behaves as a slab in exchange, and is kept when boxes are released
+  // by prefetch.
+  {
+    if (verbose) std::cout << "Testing allocation from a file\n";
+    using AllocBy = LevelData<BaseFab<Real> >::AllocBy;
+    LevelData<BaseFab<Real> > file(dbl, 2, 1, AllocBy::file);
+    if (file.allocBy() != AllocBy::file || file.slabPtr() == nullptr)
+      ++status;
+    for (size_t i = 0; i != file.slabSize(); ++i)
+      {
+        if (file.slabPtr()[i] != 0.) ++status;
+      }
+    // The slab is a mapping of an unlinked file in the scratch directory
+    {
+      const std::uintptr_t addr =
+        reinterpret_cast<std::uintptr_t>(file.slabPtr());
+      std::ifstream maps("/proc/self/maps");
+      std::string line;
+      bool mapped = false;
+      while (std::getline(maps, line))
+        {
+          std::uintptr_t begin, end;
+          char dash;
+          std::istringstream fields(line);
+          fields >> std::hex >> begin >> dash >> end;
+          if (addr >= begin && addr < end)
+            {
+              mapped = (line.find(System::scratchDir()) != std::string::npos &&
+                        line.find("(deleted)") != std::string::npos);
+              if (verbose) std::cout << line << std::endl;
+            }
+        }
+      if (maps.is_open() && !mapped) ++status;
+    }
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        file.prefetch(dit);
+        file[dit].copy(dbl[dit], lvldata[dit]);
+      }
+    Copier copierF;
+    copierF.defineExchangeLD<BaseFab<Real> >(file);
+    file.exchange(copierF);
+    // Two passes so every box has been released and read back
+    for (int pass = 0; pass != 2; ++pass)
+      {
+        for (DataIterator dit(dbl); dit.ok(); ++dit)
+          {
+            file.prefetch(dit, 2);
+            const BaseFab<Real>& fab = file[dit];
+            const BaseFab<Real>& fabRef = lvldata[dit];
+            for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+              {
+                if (!domain.contains(*bit)) continue;
+                if (fab(*bit, 0) != fabRef(*bit, 0) ||
+                    fab(*bit, 1) != fabRef(*bit, 1)) ++status;
+              }
+          }
+      }
+    // Mapping fails if the scratch directory does not exist
+    System::setScratchDir("/nonexistent/scratch");
+    void* addr = nullptr;
+    if (System::memalignFile(&addr, 64, 1024) == 0) ++status;
+    System::setScratchDir(nullptr);
+    if (System::memalignFile(&addr, 64, 1024) != 0) ++status;
+    System::freeLarge(addr);
+  }
+
+  // Test first touch and page placement.  All pages of the data are on
+  // some node once set (the query may be unavailable).
+  {
+    if (verbose) std::cout << "Testing page placement\n";
+    LevelData<BaseFab<Real> > lvldataT(dbl, 2, 1);
+    lvldataT.setVal(1.);
+    std::vector<int> numPageNode;
+    const int numUntouched = lvldataT.pageNodes(numPageNode);
+    if (numUntouched > 0) ++status;
+    if (numUntouched == 0)
+      {
+        int numPage = 0;
+        for (const int n : numPageNode) numPage += n;
+        if (numPage == 0) ++status;
+        if (verbose)
+          {
+            std::cout << "Pages on nodes:";
+            for (const int n : numPageNode) std::cout << ' ' << n;
+            std::cout << std::endl;
+          }
+      }
+    LevelData<BaseFab<Real> > slabT(
+      dbl, 2, 1, LevelData<BaseFab<Real> >::AllocBy::slab);
+    slabT.setVal(1.);
+    if (slabT.pageNodes(numPageNode) > 0) ++status;
+  }
+
+  // Test periodic exchange with a layout that is not a lattice and ghost
+  // cells extending into more than the adjacent boxes
+  {
+    if (verbose) std::cout << "Testing exchange with list of boxes\n";
+    const Box domain2(IntVect::Zero, IntVect(D_DECL(9, 5, 3)));
+    const IntVect domainDim = domain2.dimensions();
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(3, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(9, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(0, 3, 0)), IntVect(D_DECL(6, 5, 3)));
+    boxes.emplace_back(IntVect(D_DECL(7, 3, 0)), IntVect(D_DECL(9, 5, 3)));
+    DisjointBoxLayout dbl2(domain2, boxes, std::vector<int>(4, 0));
+    // Value of a cell, periodic in x and y
+    auto cellVal = [&domainDim](IntVect a_iv) -> Real
+      {
+        for (int dir = 0; dir != 2; ++dir)
+          {
+            a_iv[dir] = (a_iv[dir] + domainDim[dir]) % domainDim[dir];
+          }
+        return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+      };
+    LevelData<BaseFab<Real> > lvldata2(dbl2, 1, 4);
+    lvldata2.setVal(-1.);
+    for (DataIterator dit(dbl2); dit.ok(); ++dit)
+      {
+        BaseFab<Real>& fab = lvldata2[dit];
+        for (BoxIterator bit(dbl2[dit]); bit.ok(); ++bit)
+          {
+            fab(*bit, 0) = cellVal(*bit);
+          }
+      }
+    Copier copier2;
+    copier2.defineExchangeLD(lvldata2, PeriodicX | PeriodicY);
+    // A copier restored from a cache has the same motion items
+    {
+      std::stringstream cache;
+      copier2.writeBinary(cache);
+      Copier copierR;
+      if (copierR.readBinary(cache, dbl2, PeriodicX) != 2) ++status;
+      cache.seekg(0);
+      if (copierR.readBinary(cache, dbl2, PeriodicX | PeriodicY) != 0) ++status;
+      if (copierR.numMotionItem() != copier2.numMotionItem()) ++status;
+      if (copierR.tag() != dbl2.tag()) ++status;
+      for (int i = 0; i != copier2.numMotionItem(); ++i)
+        {
+          if (copierR[i].regionRecv() != copier2[i].regionRecv() ||
+              copierR[i].regionSend() != copier2[i].regionSend() ||
+              copierR[i].sendDir() != copier2[i].sendDir() ||
+              copierR[i].bidxRecv().globalIndex() !=
+              copier2[i].bidxRecv().globalIndex() ||
+              copierR[i].bidxSend().globalIndex() !=
+              copier2[i].bidxSend().globalIndex()) ++status;
+        }
+    }
+    lvldata2.exchange(copier2);
+    for (DataIterator dit(dbl2); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = lvldata2[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (g_SpaceDim > 2 && ((*bit)[2] < 0 || (*bit)[2] > 3)) continue;
+            if (fab(*bit, 0) != cellVal(*bit)) ++status;
+          }
+      }
+  }
+
+  // Test per-box views of data on a layout with the boxes fused into a
+  // single box
+  {
+    if (verbose) std::cout << "Testing views of fused layout\n";
+    const Box domain3(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+    const IntVect domainDim = domain3.dimensions();
+    DisjointBoxLayout dbl3(domain3, 4*IntVect::Unit);
+    DisjointBoxLayout fusedDbl;
+    fusedDbl.defineFused(dbl3);
+    if (fusedDbl.size() != 1 || fusedDbl.getLinear(0).box != domain3)
+      ++status;
+    auto cellVal = [&domainDim](IntVect a_iv) -> Real
+      {
+        for (int dir = 0; dir != 2; ++dir)
+          {
+            a_iv[dir] = (a_iv[dir] + domainDim[dir]) % domainDim[dir];
+          }
+        return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+      };
+    LevelData<BaseFab<Real> > fused(fusedDbl, 1, 1);
+    fused.setVal(-1.);
+    LevelData<BaseFab<Real> > views;
+    views.defineView(fused, dbl3);
+    if (views.size() != dbl3.localSize() || views.nghost() != 1) ++status;
+    for (DataIterator dit(dbl3); dit.ok(); ++dit)
+      {
+        BaseFab<Real>& fab = views[dit];
+        for (BoxIterator bit(dbl3[dit]); bit.ok(); ++bit)
+          {
+            fab(*bit, 0) = cellVal(*bit);
+          }
+      }
+    // Ghosts inside the fused box are already filled and the remainder
+    // are filled by exchanging the fused data
+    Copier copier3;
+    copier3.defineExchangeLD(fused, PeriodicX | PeriodicY);
+    fused.exchange(copier3);
+    for (DataIterator dit(dbl3); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = views[dit];
+        Box box = dbl3[dit];
+        box.grow(1);
+        if (fab.box() != box) ++status;
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (g_SpaceDim > 2 && ((*bit)[2] < 0 || (*bit)[2] > 3)) continue;
+            if (fab(*bit, 0) != cellVal(*bit)) ++status;
+          }
+      }
+  }
+
+  // Test views of a range of components.  Exchanging the view only fills
+  // the ghosts of the viewed component.
+  {
+    if (verbose) std::cout << "Testing views of components\n";
+    const Box domainC(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+    const IntVect domainDim = domainC.dimensions();
+    DisjointBoxLayout dblC(domainC, 4*IntVect::Unit);
+    auto cellVal = [&domainDim](IntVect a_iv) -> Real
+      {
+        for (int dir = 0; dir != 2; ++dir)
+          {
+            a_iv[dir] = (a_iv[dir] + domainDim[dir]) % domainDim[dir];
+          }
+        return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+      };
+    LevelData<BaseFab<Real> > data(dblC, 3, 1);
+    data.setVal(-1.);
+    LevelData<BaseFab<Real> > view;
+    view.defineView(data, 1, 1);
+    if (view.ncomp() != 1 || view.nghost() != 1 ||
+        view.size() != dblC.localSize()) ++status;
+    for (DataIterator dit(dblC); dit.ok(); ++dit)
+      {
+        BaseFab<Real>& fab = view[dit];
+        if (fab.box() != data[dit].box() ||
+            fab.dataPtr() != data[dit].dataPtr(1)) ++status;
+        for (BoxIterator bit(dblC[dit]); bit.ok(); ++bit)
+          {
+            fab(*bit, 0) = cellVal(*bit);
+          }
+      }
+    Copier copierC;
+    copierC.defineExchangeLD(view, PeriodicX | PeriodicY);
+    view.exchange(copierC);
+    for (DataIterator dit(dblC); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = data[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (fab(*bit, 0) != -1. || fab(*bit, 2) != -1.) ++status;
+            if (g_SpaceDim > 2 && ((*bit)[2] < 0 || (*bit)[2] > 3)) continue;
+            if (fab(*bit, 1) != cellVal(*bit)) ++status;
+          }
+      }
+    if (view.sum(0, 1) != data.sum(1, 2)) ++status;
+  }
+
+  // Test moving and swapping.  Only the handles move so the BaseFabs keep
+  // their data and addresses, and moved-from LevelData are empty.
+  {
+    if (verbose) std::cout << "Testing move and swap\n";
+    using AllocBy = LevelData<BaseFab<Real> >::AllocBy;
+    LevelData<BaseFab<Real> > a(dbl, 2, 1);
+    LevelData<BaseFab<Real> > b(dbl, 1, 2, AllocBy::slab);
+    a.setVal(1.);
+    b.setVal(2.);
+    const Real* aPtr = a.getLinear(0).dataPtr();
+    const Real* bSlab = b.slabPtr();
+    LevelData<BaseFab<Real> > c(std::move(a));
+    if (c.getLinear(0).dataPtr() != aPtr || c.ncomp() != 2 ||
+        c.nghost() != 1 || c.size() != numBox) ++status;
+    if (a.size() != 0 || a.ncomp() != 0) ++status;
+    swap(c, b);
+    if (c.slabPtr() != bSlab || c.allocBy() != AllocBy::slab ||
+        c.ncomp() != 1 || c.nghost() != 2) ++status;
+    if (b.getLinear(0).dataPtr() != aPtr || b.allocBy() != AllocBy::box)
+      ++status;
+    if (b.sum(0, 2) != 2.*domain.size() || c.sum(0, 1) != 2.*domain.size())
+      ++status;
+    a = std::move(c);
+    if (a.slabPtr() != bSlab || c.size() != 0 || c.slabPtr() != nullptr)
+      ++status;
+    // A Copier defined for one LevelData exchanges the other after a swap
+    LevelData<BaseFab<Real> > d(dbl, 1, 2);
+    Copier copier;
+    copier.defineExchangeLD(d);
+    d.swap(a);
+    d.setVal(-1.);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        d[dit].setValOMP(2., dbl[dit]);
+      }
+    d.exchange(copier);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = d[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (domain.contains(*bit) && fab(*bit, 0) != 2.) ++status;
+          }
+      }
+  }
+
+  // Test a layout without the inactive boxes (the column of boxes at
+  // x = 4).  No data is allocated for them and exchange leaves ghosts next
+  // to them untouched.
+  {
+    if (verbose) std::cout << "Testing layout of active boxes\n";
+    const Box domain4(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+    const IntVect domainDim = domain4.dimensions();
+    DisjointBoxLayout dbl4(domain4, 4*IntVect::Unit);
+    std::vector<int> localActive(dbl4.localSize());
+    for (DataIterator dit(dbl4); dit.ok(); ++dit)
+      {
+        localActive[(*dit).localIndex()] = (dbl4[dit].loVect()[0] != 4);
+      }
+    DisjointBoxLayout activeDbl;
+    activeDbl.defineActive(dbl4, localActive);
+    if (activeDbl.size() != 6 || activeDbl.localSize() != 6) ++status;
+    std::vector<int> map;
+    if (activeDbl.mapIndices(dbl4, map) != 0) ++status;
+    auto wrap = [&domainDim](IntVect a_iv) -> IntVect
+      {
+        for (int dir = 0; dir != 2; ++dir)
+          {
+            a_iv[dir] = (a_iv[dir] + domainDim[dir]) % domainDim[dir];
+          }
+        return a_iv;
+      };
+    LevelData<BaseFab<Real> > active(activeDbl, 1, 1);
+    if (active.size() != 6) ++status;
+    active.setVal(-1.);
+    for (DataIterator dit(activeDbl); dit.ok(); ++dit)
+      {
+        if (activeDbl[dit].loVect()[0] == 4) ++status;
+        for (BoxIterator bit(activeDbl[dit]); bit.ok(); ++bit)
+          {
+            active[dit](*bit, 0) = D_TERM((*bit)[0], + 100*(*bit)[1],
+                                          + 10000*(*bit)[2]);
+          }
+      }
+    Copier copier4;
+    copier4.defineExchangeLD(active, PeriodicX | PeriodicY);
+    active.exchange(copier4);
+    for (DataIterator dit(activeDbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = active[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (g_SpaceDim > 2 && ((*bit)[2] < 0 || (*bit)[2] > 3)) continue;
+            const IntVect iv = wrap(*bit);
+            const Real expected = (iv[0] >= 4 && iv[0] < 8) ?
+              -1. : D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]);
+            if (fab(*bit, 0) != expected) ++status;
+          }
+      }
+  }
+
+  // Test arithmetic and reductions.  Only valid cells are modified or
+  // reduced.
+  {
+    if (verbose) std::cout << "Testing arithmetic\n";
+    DisjointBoxLayout dblR(domain, 4*IntVect::Unit);
+    LevelData<BaseFab<Real> > x(dblR, 2, 1);
+    LevelData<BaseFab<Real> > y(dblR, 2, 1);
+    x.setVal(100.);
+    y.setVal(100.);
+    Real refSum = 0.;
+    Real refMin = 1000.;
+    Real refNorm1 = 0.;
+    for (DataIterator dit(dblR); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(dblR[dit]); bit.ok(); ++bit)
+          {
+            const Real v = D_TERM((*bit)[0], - (*bit)[1], + 2*(*bit)[2]);
+            x[dit](*bit, 0) = v;
+            x[dit](*bit, 1) = -v;
+            refSum += v;
+            refMin = std::min(refMin, -v);
+            refNorm1 += std::fabs(3. + 2.*v) + std::fabs(3. - 2.*v);
+          }
+      }
+    // y = 3 + 2x, then x = y - x = 3 + x (also after x = (x + x)/2)
+    y.setVal(0.);
+    y.plus(1.5);
+    y.plus(x);
+    y.mult(2.);
+    x.lincomb(-1., x, 1., y);
+    x.axpy(1., x);
+    x.mult(0.5);
+    if (x.sum(0, 1) != refSum + 3.*domain.size() ||
+        x.sum(0, 2) != 6.*domain.size() ||
+        x.min(1, 2) != refMin + 3. ||
+        x.max(0, 2) != -refMin + 3. ||
+        x.norm(0, 0, 1) != -refMin + 3. ||
+        y.norm(1, 0, 2) != refNorm1) ++status;
+    for (DataIterator dit(dblR); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = x[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (!dblR[dit].contains(*bit) && fab(*bit, 0) != 100.) ++status;
+          }
+      }
+  }
+
+  // Test reduced-precision storage.  Exchange moves the stored bytes (the
+  // values are exact in BFloat16) and reductions are computed in Real.
+  {
+    if (verbose) std::cout << "Testing reduced-precision storage\n";
+    using HalfFab = BaseFab<BFloat16>;
+    LevelData<HalfFab> half(dbl, 2, 1, LevelData<HalfFab>::AllocBy::slab);
+    half.setVal(BFloat16(-100.));
+    Real refSum = 0.;
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+          {
+            half[dit](*bit, 0) = lvldata[dit](*bit, 0);
+            half[dit](*bit, 1) = lvldata[dit](*bit, 1);
+            refSum += lvldata[dit](*bit, 0);
+          }
+      }
+    Copier copierH;
+    copierH.defineExchangeLD<HalfFab>(half);
+    half.exchange(copierH);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        const HalfFab& fab = half[dit];
+        const BaseFab<Real>& fabRef = lvldata[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (!domain.contains(*bit)) continue;
+            if (fab(*bit, 0) != fabRef(*bit, 0) ||
+                fab(*bit, 1) != fabRef(*bit, 1)) ++status;
+          }
+      }
+    // Accumulating 2 + 4 + ... in BFloat16 would lose the low bits
+    half.mult(2.);
+    half.plus(0.25);
+    if (half.sum(0, 1) != 2.*refSum + 0.25*domain.size() ||
+        half.max(1, 2) != -2. + 0.25) ++status;
+  }
 #endif
 
 //--Output status
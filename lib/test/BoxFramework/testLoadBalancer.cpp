@@ -0,0 +1,172 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+#include "BaseFab.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "LoadBalancer.H"
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  // 4 x 2 x 1 boxes
+  const Box domain(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+  DisjointBoxLayout dbl(domain, 4*IntVect::Unit);
+
+  // Partition along the Morton curve.  Boxes with y = 0 cost 3, others cost
+  // 1.  The curve visits (0,0), (1,0), (0,1), (1,1) before (2,0), so the
+  // first process should get the left half of the boxes.
+  {
+    std::vector<double> cost(dbl.size());
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        cost[idx] = (dbl.getLinear(idx).box.loVect()[1] == 0) ? 3. : 1.;
+      }
+    std::vector<int> procs;
+    LoadBalancer::partitionSFC(dbl, cost, 2, procs);
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        const int expectProc = (dbl.getLinear(idx).box.loVect()[0] < 8) ? 0 : 1;
+        if (procs[idx] != expectProc) ++status;
+        if (verbose)
+          {
+            std::cout << "Box " << dbl.getLinear(idx).box << " on proc "
+                      << procs[idx] << std::endl;
+          }
+      }
+    if (LoadBalancer::imbalance(cost, procs, 2) != 1.) ++status;
+    // Lattice ordering (first 4 boxes on proc 0) is imbalanced
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        procs[idx] = idx/4;
+      }
+    if (LoadBalancer::imbalance(cost, procs, 2) != 1.5) ++status;
+    // No cost gives an equal number of boxes per process
+    cost.assign(dbl.size(), 0.);
+    LoadBalancer::partitionSFC(dbl, cost, 4, procs);
+    std::vector<int> count(4, 0);
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        ++count[procs[idx]];
+      }
+    for (int c : count)
+      {
+        if (c != 2) ++status;
+      }
+  }
+
+  // Partition among 2 nodes, each with 2 processes (numbered alternately).
+  // Each node should receive half of the domain in x and each process a
+  // column of boxes.
+  {
+    std::vector<int> procs;
+    LoadBalancer::partitionNodes(dbl, std::vector<double>(dbl.size(), 0.),
+                                 std::vector<int>{ 0, 1, 0, 1 }, procs);
+    const int expectProc[] = { 0, 2, 1, 3 };
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        const int iBox = dbl.getLinear(idx).box.loVect()[0]/4;
+        if (procs[idx] != expectProc[iBox]) ++status;
+        if (verbose)
+          {
+            std::cout << "Box " << dbl.getLinear(idx).box << " on proc "
+                      << procs[idx] << std::endl;
+          }
+      }
+    // With costs, the first node gets only the expensive boxes with x < 4
+    std::vector<double> cost(dbl.size());
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        cost[idx] = (dbl.getLinear(idx).box.loVect()[0] < 4) ? 4. : 1.;
+      }
+    LoadBalancer::partitionNodes(dbl, cost, std::vector<int>{ 0, 0, 1, 1 },
+                                 procs);
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        const int expectNode = (dbl.getLinear(idx).box.loVect()[0] < 4) ?
+          0 : 1;
+        if (procs[idx]/2 != expectNode) ++status;
+      }
+    if (LoadBalancer::imbalance(cost, procs, 4) > 1.2) ++status;
+  }
+
+  // Map indices between layouts
+  {
+    DisjointBoxLayout dbl2;
+    dbl2.defineReassign(dbl, std::vector<int>(dbl.size(), 0));
+    std::vector<int> map;
+    if (dbl.mapIndices(dbl2, map) != 0) ++status;
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        if (dbl.getLinear(idx).box != dbl2.getLinear(map[idx]).box) ++status;
+      }
+    DisjointBoxLayout dbl3(domain, IntVect(D_DECL(8, 8, 4)));
+    if (dbl.mapIndices(dbl3, map) == 0) ++status;
+  }
+
+  // Costs, rebalancing, and migration on a single process
+  {
+    LevelData<BaseFab<Real> > lvldata(dbl, 1, 1);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        lvldata[dit].setVal((Real)(*dit).globalIndex());
+      }
+    LoadBalancer loadBalancer(dbl);
+    loadBalancer.registerLevelData(lvldata);
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        loadBalancer.startTimer(*dit);
+        loadBalancer.stopTimer(*dit);
+        loadBalancer.addCost(*dit, 2.);
+        if (loadBalancer.cost(*dit) < 2.) ++status;
+      }
+    std::vector<double> globalCost;
+    loadBalancer.gatherCosts(globalCost);
+    if ((int)globalCost.size() != dbl.size()) ++status;
+    for (double c : globalCost)
+      {
+        if (c < 2.) ++status;
+      }
+    if (loadBalancer.imbalance() != 1.) ++status;
+    // Nothing to do with one process
+    if (loadBalancer.rebalance()) ++status;
+    for (DataIterator dit(dbl); dit.ok(); ++dit)
+      {
+        if (loadBalancer.cost(*dit) != 0.) ++status;
+      }
+
+    // Explicit migration to a new (identical) layout
+    DisjointBoxLayout dbl2;
+    dbl2.defineReassign(dbl, std::vector<int>(dbl.size(), 0));
+    lvldata.migrate(dbl2);
+    if (lvldata.tag() != dbl2.tag()) ++status;
+    for (DataIterator dit(dbl2); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = lvldata[dit];
+        Box box = dbl2[dit];
+        box.grow(1);
+        if (fab.box() != box) ++status;
+        if (fab(dbl2[dit].loVect(), 0) != (Real)(*dit).globalIndex()) ++status;
+      }
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testLoadBalancer";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 #include <unistd.h>
 
 #include "BaseFab.H"
@@ -74,6 +75,23 @@ int main(int argc, const char* argv[])
       lvldata[dit].setVal(procID + 0.5);
     }
   MPI_Barrier(MPI_COMM_WORLD);
+
+  // Reductions include the valid cells of all processes
+  {
+    Real refSum = 0.;
+    Real refMin = 1000.;
+    Real refMax = -1000.;
+    for (LayoutIterator lit(dbl); lit.ok(); ++lit)
+      {
+        const Real val = dbl.proc(lit) + 0.5;
+        refSum += dbl[lit].size()*val;
+        refMin = std::min(refMin, val);
+        refMax = std::max(refMax, val);
+      }
+    if (lvldata.sum(0, 1) != refSum || lvldata.norm(1, 0, 1) != refSum ||
+        lvldata.min(0, 1) != refMin || lvldata.max(0, 1) != refMax ||
+        lvldata.norm(0, 0, 1) != refMax) ++status;
+  }
   if (verbose)
     {
       for (int iProc = 0; iProc != numProc; ++iProc)
@@ -1,10 +1,13 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <cmath>
+#include <vector>
 
 #include "BaseFab.H"
 #include "DisjointBoxLayout.H"
 #include "LevelData.H"
+#include "AMRHierarchy.H"
 
 int main(int argc, const char* argv[])
 {
@@ -153,6 +156,181 @@ int main(int argc, const char* argv[])
     }
 #endif
 
+  // Periodic exchange between processes with a layout that is not a lattice.
+  // Boxes are assigned to processes out of order.
+  {
+    const Box domain2(IntVect::Zero, IntVect(D_DECL(9, 5, 3)));
+    const IntVect domainDim = domain2.dimensions();
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(0, 0, 0)), IntVect(D_DECL(3, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(9, 2, 3)));
+    boxes.emplace_back(IntVect(D_DECL(0, 3, 0)), IntVect(D_DECL(6, 5, 3)));
+    boxes.emplace_back(IntVect(D_DECL(7, 3, 0)), IntVect(D_DECL(9, 5, 3)));
+    DisjointBoxLayout dbl2(domain2, boxes, std::vector<int>{ 1, 0, 0, 1 });
+    if (dbl2.localSize() != 2) ++status;
+    // Value of a cell, periodic in x and y
+    auto cellVal = [&domainDim](IntVect a_iv) -> Real
+      {
+        for (int dir = 0; dir != 2; ++dir)
+          {
+            a_iv[dir] = (a_iv[dir] + domainDim[dir]) % domainDim[dir];
+          }
+        return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+      };
+    // Fill the interior, exchange, and count errors in the ghosts
+    auto exchangeErrors = [&cellVal](const DisjointBoxLayout& a_dbl,
+                                     Copier&                  a_copier)
+      {
+        int numErr = 0;
+        LevelData<BaseFab<Real> > lvldata2(a_dbl, 1, 2);
+        lvldata2.setVal(-1.);
+        for (DataIterator dit(a_dbl); dit.ok(); ++dit)
+          {
+            BaseFab<Real>& fab = lvldata2[dit];
+            for (BoxIterator bit(a_dbl[dit]); bit.ok(); ++bit)
+              {
+                fab(*bit, 0) = cellVal(*bit);
+              }
+          }
+        lvldata2.exchange(a_copier);
+        for (DataIterator dit(a_dbl); dit.ok(); ++dit)
+          {
+            const BaseFab<Real>& fab = lvldata2[dit];
+            for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+              {
+                if (g_SpaceDim > 2 && ((*bit)[2] < 0 || (*bit)[2] > 3))
+                  continue;
+                if (fab(*bit, 0) != cellVal(*bit)) ++numErr;
+              }
+          }
+        return numErr;
+      };
+    Copier copier2;
+    copier2.defineExchangeDBL<Real>(dbl2, 2, 0, 1, PeriodicX | PeriodicY);
+    status += exchangeErrors(dbl2, copier2);
+
+    // The same layout and copier restored from a cache (one per process)
+    std::stringstream cache;
+    dbl2.writeBinary(cache);
+    copier2.writeBinary(cache);
+    DisjointBoxLayout dbl3;
+    Copier copier3;
+    if (dbl3.readBinary(cache, domain2, IntVect::Zero) != 0) ++status;
+    if (copier3.readBinary(cache, dbl3, PeriodicX | PeriodicY) != 0) ++status;
+    if (dbl3.localSize() != 2) ++status;
+    if (copier3.numMotionItem() != copier2.numMotionItem()) ++status;
+    if (copier3.numRequest() != copier2.numRequest()) ++status;
+    status += exchangeErrors(dbl3, copier3);
+  }
+
+  // Inactive boxes on both processes are left out of the layout and
+  // exchanges skip them
+  {
+    const Box domain4(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+    DisjointBoxLayout dbl4(domain4, 4*IntVect::Unit);
+    const Box inactiveA(IntVect(D_DECL(4, 0, 0)), IntVect(D_DECL(7, 3, 3)));
+    const Box inactiveB(IntVect(D_DECL(12, 4, 0)), IntVect(D_DECL(15, 7, 3)));
+    std::vector<int> localActive(dbl4.localSize());
+    for (DataIterator dit(dbl4); dit.ok(); ++dit)
+      {
+        localActive[(*dit).localIndex()] =
+          (dbl4[dit] != inactiveA && dbl4[dit] != inactiveB);
+      }
+    DisjointBoxLayout activeDbl;
+    activeDbl.defineActive(dbl4, localActive);
+    if (activeDbl.size() != 6 || activeDbl.localSize() != 3) ++status;
+    LevelData<BaseFab<Real> > active(activeDbl, 1, 1);
+    active.setVal(-1.);
+    auto cellVal = [](const IntVect& a_iv) -> Real
+      {
+        return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+      };
+    for (DataIterator dit(activeDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(activeDbl[dit]); bit.ok(); ++bit)
+          {
+            active[dit](*bit, 0) = cellVal(*bit);
+          }
+      }
+    Copier copier4;
+    copier4.defineExchangeLD(active);
+    active.exchange(copier4);
+    for (DataIterator dit(activeDbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = active[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if (!domain4.contains(*bit)) continue;
+            const Real expected =
+              (inactiveA.contains(*bit) || inactiveB.contains(*bit)) ?
+              -1. : cellVal(*bit);
+            if (fab(*bit, 0) != expected) ++status;
+          }
+      }
+  }
+
+  // Coarse-fine ghosts and averaging between processes.  Level 0 has 2 x 2
+  // boxes (y = 0 on process 0) and each fine box is on the other process
+  // from most of the coarse cells it covers.
+  {
+    const Box crDomain(IntVect::Zero, IntVect(D_DECL(7, 7, 3)));
+    const DisjointBoxLayout crDbl(crDomain, 4*IntVect::Unit);
+    Box fnDomain(crDomain);
+    fnDomain.refine(2);
+    std::vector<Box> boxes;
+    boxes.emplace_back(IntVect(D_DECL(4, 4, 0)), IntVect(D_DECL(7, 11, 7)));
+    boxes.emplace_back(IntVect(D_DECL(8, 4, 0)), IntVect(D_DECL(11, 11, 7)));
+    const DisjointBoxLayout fnDbl(fnDomain, boxes, std::vector<int>{ 1, 0 });
+    AMRHierarchy amr(crDbl, 1, 2);
+    amr.addLevel(fnDbl, 2);
+    // Linear in x and y at cell centers
+    auto linear = [](const IntVect& a_iv, const Real a_dx) -> Real
+      {
+        return (a_iv[0] + 0.5)*a_dx + 2.*(a_iv[1] + 0.5)*a_dx;
+      };
+    for (DataIterator dit(crDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(crDbl[dit]); bit.ok(); ++bit)
+          {
+            amr.data(0)[dit](*bit, 0) = linear(*bit, 1.);
+          }
+      }
+    LevelData<FArrayBox>& fnData = amr.data(1);
+    fnData.setVal(-1.);
+    for (DataIterator dit(fnDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(fnDbl[dit]); bit.ok(); ++bit)
+          {
+            fnData[dit](*bit, 0) = linear(*bit, 0.5);
+          }
+      }
+    amr.fillGhosts(1, fnData, amr.time(1));
+    for (DataIterator dit(fnDbl); dit.ok(); ++dit)
+      {
+        const FArrayBox& fab = fnData[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            const Real expected = fnDomain.contains(*bit) ?
+              linear(*bit, 0.5) : -1.;
+            if (std::fabs(fab(*bit, 0) - expected) > 1.E-12) ++status;
+          }
+      }
+    // Averages of linear data are exact
+    amr.data(0).setVal(-1.);
+    amr.averageDown(1);
+    const Box crCover(IntVect(D_DECL(2, 2, 0)), IntVect(D_DECL(5, 5, 3)));
+    for (DataIterator dit(crDbl); dit.ok(); ++dit)
+      {
+        const FArrayBox& fab = amr.data(0)[dit];
+        for (BoxIterator bit(crDbl[dit]); bit.ok(); ++bit)
+          {
+            const Real expected = crCover.contains(*bit) ?
+              linear(*bit, 1.) : -1.;
+            if (std::fabs(fab(*bit, 0) - expected) > 1.E-12) ++status;
+          }
+      }
+  }
+
   // Get sum of all status into master process
   int allStatus;
   MPI_Reduce(&status, &allStatus, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
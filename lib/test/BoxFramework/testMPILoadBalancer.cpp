@@ -0,0 +1,277 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "BaseFab.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "LoadBalancer.H"
+#include "BergerRigoutsos.H"
+
+// Value stored at a cell (periodic in x and y)
+Real cellVal(IntVect a_iv, const Box& a_domain)
+{
+  const IntVect len = a_domain.dimensions();
+  for (int dir = 0; dir != 2; ++dir)
+    {
+      a_iv[dir] = (a_iv[dir] + len[dir]) % len[dir];
+    }
+  return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]);
+}
+
+int main(int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Initialize MPI
+
+  DisjointBoxLayout::initMPI(argc, argv);
+  int numProc = DisjointBoxLayout::numProc();
+  int procID = DisjointBoxLayout::procID();
+  const bool masterProc = (procID == 0);
+
+  if (numProc != 2)
+    {
+       if (masterProc)
+         {
+           std::cout << "Error: this test must be run with 2 processes!\n";
+         }
+       MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+//--Tests
+
+  // 4 x 2 x 1 boxes.  Initially, boxes with y = 0 are on process 0.
+  const Box domain(IntVect::Zero, IntVect(D_DECL(15, 7, 3)));
+  DisjointBoxLayout dbl(domain, 4*IntVect::Unit);
+  // An even assignment in lattice order does not store the boxes
+  if (!dbl.isImplicit()) ++status;
+
+  // An explicit assignment out of lattice order (columns of boxes)
+  {
+    std::vector<int> procs(dbl.size());
+    for (int idx = 0; idx != dbl.size(); ++idx)
+      {
+        procs[idx] = (idx % 4) & 1;
+      }
+    DisjointBoxLayout dblCol(domain, 4*IntVect::Unit, procs);
+    if (dblCol.isImplicit()) ++status;
+    if (dblCol.localSize() != 4) ++status;
+    for (DataIterator dit(dblCol); dit.ok(); ++dit)
+      {
+        const int iBox = dblCol[dit].loVect()[0]/4;
+        if ((iBox & 1) != procID) ++status;
+      }
+    // Every box has 3 neighbours in the lattice (no trimming)
+    for (LayoutIterator lit(dblCol); lit.ok(); ++lit)
+      {
+        int numNbr = 0;
+        for (NeighborIterator nbrit(lit); nbrit.ok(); ++nbrit)
+          {
+            Box box = dblCol[lit];
+            box.grow(1);
+            box &= dblCol[nbrit];
+            if (box.isEmpty()) ++status;
+            ++numNbr;
+          }
+        if (numNbr != ((dblCol[lit].loVect()[0] % 12 == 0) ? 3 : 5)) ++status;
+      }
+  }
+
+  LevelData<BaseFab<Real> > lvldata(dbl, 1, 1);
+  lvldata.setVal(-1.);
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
+    {
+      BaseFab<Real>& fab = lvldata[dit];
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          fab(*bit, 0) = cellVal(*bit, domain);
+        }
+    }
+  Copier copier;
+  copier.defineExchangeLD(lvldata, PeriodicX | PeriodicY);
+  // Data allocated from a slab migrates into a new slab
+  LevelData<BaseFab<Real> > lvldataSlab(
+    dbl, 2, 0, LevelData<BaseFab<Real> >::AllocBy::slab);
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
+    {
+      BaseFab<Real>& fab = lvldataSlab[dit];
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          fab(*bit, 0) = cellVal(*bit, domain);
+          fab(*bit, 1) = -cellVal(*bit, domain);
+        }
+    }
+
+  LoadBalancer loadBalancer(dbl);
+  loadBalancer.registerLevelData(lvldata);
+  loadBalancer.registerLevelData(lvldataSlab);
+  loadBalancer.registerCopier(copier);
+
+  // Boxes with y = 0 cost 3, others cost 1
+  for (DataIterator dit(dbl); dit.ok(); ++dit)
+    {
+      loadBalancer.addCost(*dit, (dbl[dit].loVect()[1] == 0) ? 3. : 1.);
+    }
+  if (loadBalancer.imbalance() != 1.5) ++status;
+  if (!loadBalancer.rebalance()) ++status;
+  const DisjointBoxLayout& newDbl = loadBalancer.disjointBoxLayout();
+  if (lvldata.tag() != newDbl.tag()) ++status;
+  if (copier.tag() != newDbl.tag()) ++status;
+  if (newDbl.localSize() != 4) ++status;
+
+  if (lvldataSlab.tag() != newDbl.tag() || lvldataSlab.slabPtr() == nullptr)
+    ++status;
+  for (DataIterator dit(newDbl); dit.ok(); ++dit)
+    {
+      const BaseFab<Real>& fab = lvldataSlab[dit];
+      if (fab.dataPtr() < lvldataSlab.slabPtr() ||
+          fab.dataPtr() + fab.size() >
+          lvldataSlab.slabPtr() + lvldataSlab.slabSize()) ++status;
+      for (BoxIterator bit(newDbl[dit]); bit.ok(); ++bit)
+        {
+          if (fab(*bit, 0) != cellVal(*bit, domain) ||
+              fab(*bit, 1) != -cellVal(*bit, domain)) ++status;
+        }
+    }
+
+  // Boxes with x < 8 are now on process 0
+  for (DataIterator dit(newDbl); dit.ok(); ++dit)
+    {
+      const int expectProc = (newDbl[dit].loVect()[0] < 8) ? 0 : 1;
+      if (expectProc != procID) ++status;
+    }
+
+  // Of the 10 faces between boxes, only the 2 at x = 8 are between processes
+  {
+    DisjointBoxLayout::Statistics stats;
+    newDbl.statistics(stats);
+    int numBox = 0;
+    for (const int n : stats.numBoxNode) numBox += n;
+    if (numBox != newDbl.size()) ++status;
+    const int faceArea = (4*IntVect::Unit).product()/4;
+    if (stats.numFaceCellNode + stats.numFaceCellInterNode != 2*faceArea)
+      ++status;
+    if (stats.numFaceCellProc != 8*faceArea) ++status;
+  }
+
+  // Data has moved with the boxes and exchange with the rebuilt copier fills
+  // all ghosts inside the domain in z
+  lvldata.exchange(copier);
+  for (int iProc = 0; iProc != numProc; ++iProc)
+    {
+      if (iProc == procID)
+        {
+          for (DataIterator dit(newDbl); dit.ok(); ++dit)
+            {
+              const BaseFab<Real>& fab = lvldata[dit];
+              int numErr = 0;
+              for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+                {
+                  if ((*bit)[2] < 0 || (*bit)[2] > 3) continue;
+                  if (fab(*bit, 0) != cellVal(*bit, domain)) ++numErr;
+                }
+              if (verbose)
+                {
+                  std::cout << "Proc " << procID << " box " << newDbl[dit]
+                            << " errors: " << numErr << std::endl;
+                }
+              status += numErr;
+            }
+        }
+      MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+  // The boxes on each process form a block and fuse into one box.  Views of
+  // data on the fused layout see the same values after exchange.
+  {
+    DisjointBoxLayout fusedDbl;
+    fusedDbl.defineFused(newDbl);
+    if (fusedDbl.size() != 2 || fusedDbl.localSize() != 1) ++status;
+    LevelData<BaseFab<Real> > fused(fusedDbl, 1, 1);
+    fused.setVal(-1.);
+    LevelData<BaseFab<Real> > views;
+    views.defineView(fused, newDbl);
+    for (DataIterator dit(newDbl); dit.ok(); ++dit)
+      {
+        views[dit].copy(newDbl[dit], lvldata[dit]);
+      }
+    Copier fusedCopier;
+    fusedCopier.defineExchangeLD(fused, PeriodicX | PeriodicY);
+    fused.exchange(fusedCopier);
+    for (DataIterator dit(newDbl); dit.ok(); ++dit)
+      {
+        const BaseFab<Real>& fab = views[dit];
+        for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+          {
+            if ((*bit)[2] < 0 || (*bit)[2] > 3) continue;
+            if (fab(*bit, 0) != lvldata[dit](*bit, 0)) ++status;
+          }
+      }
+  }
+
+  // Balanced now
+  for (DataIterator dit(newDbl); dit.ok(); ++dit)
+    {
+      loadBalancer.addCost(*dit, (newDbl[dit].loVect()[1] == 0) ? 3. : 1.);
+    }
+  if (loadBalancer.imbalance() != 1.) ++status;
+  if (loadBalancer.rebalance()) ++status;
+
+  // Clustering tags on both processes gives the same layout everywhere, with
+  // the cells balanced between the processes
+  {
+    LevelData<BaseFab<bool>> tags(newDbl, 1, 0);
+    tags.setVal(false);
+    int numTag = 0;
+    for (DataIterator dit(newDbl); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(newDbl[dit]); bit.ok(); ++bit)
+          {
+            if ((*bit)[1] >= 2 && (*bit)[1] <= 5)
+              {
+                tags[dit](*bit, 0) = true;
+                ++numTag;
+              }
+          }
+      }
+    BergerRigoutsos br(0.75, 4*IntVect::Unit);
+    DisjointBoxLayout tagDbl;
+    br.makeLayout(tags, tagDbl);
+    int numCell[2] = { 0, 0 };
+    for (int idx = 0; idx != tagDbl.size(); ++idx)
+      {
+        const auto entry = tagDbl.getLinear(idx);
+        if (entry.box.loVect()[1] != 2 || entry.box.hiVect()[1] != 5) ++status;
+        numCell[entry.proc] += entry.box.size();
+      }
+    if (numCell[0] != numCell[1]) ++status;
+    if (numCell[procID] != numTag) ++status;
+  }
+
+  // Get sum of all status into master process
+  int allStatus;
+  MPI_Reduce(&status, &allStatus, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+//--Output status
+
+  if (masterProc)
+    {
+      if (verbose)
+        {
+          std::cout << "Status: " << allStatus << std::endl;
+        }
+      const char* const testName = "testMPILoadBalancer";
+      const char* const statLbl[] = {
+        "failed",
+        "passed"
+      };
+      std::cout << std::left << std::setw(40) << testName
+                << statLbl[(allStatus == 0)] << std::endl;
+    }
+
+  // Finalize MPI
+  DisjointBoxLayout::finalizeMPI();
+  return status;
+}
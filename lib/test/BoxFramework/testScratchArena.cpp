@@ -0,0 +1,132 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "BaseFab.H"
+#include "BoxIterator.H"
+#include "ScratchArena.H"
+
+// Per-thread scratch arena and temporary FArrayBoxes built in it.  With
+// -v, the high-water marks are reported.
+
+// Is an address aligned to the arena alignment?
+bool aligned(const void *const a_addr)
+{
+  return (reinterpret_cast<uintptr_t>(a_addr) %
+          ScratchArena::c_alignment) == 0;
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Tests
+
+  // Alignment and LIFO release
+  {
+    ScratchArena arena;
+    const size_t c = ScratchArena::c_alignment;
+    const size_t bytesB = ((100*sizeof(Real) + c - 1)/c)*c;
+    {
+      ScratchArena::Scope scope(arena);
+      char *const a = scope.allocate<char>(3);
+      Real *const b = scope.allocate<Real>(100);
+      if (!aligned(a) || !aligned(b)) ++status;
+      if (reinterpret_cast<char*>(b) - a != (std::ptrdiff_t)c) ++status;
+      if (arena.inUse() != c + bytesB) ++status;
+      {
+        ScratchArena::Scope inner(arena);
+        int *const d = inner.allocate<int>(0);
+        if (d == nullptr || !aligned(d)) ++status;
+        if (arena.inUse() != c + bytesB + c) ++status;
+      }
+      if (arena.inUse() != c + bytesB) ++status;
+      // Memory released by the inner scope is used again
+      ScratchArena::Scope inner(arena);
+      if (reinterpret_cast<char*>(inner.allocate<int>(1)) !=
+          reinterpret_cast<char*>(b) + bytesB) ++status;
+    }
+    if (arena.inUse() != 0) ++status;
+    if (arena.highWater() != c + bytesB + c) ++status;
+    if (arena.numChunkAlloc() != 1) ++status;
+  }
+
+  // Growth, coalescing, and no allocations after the first pass
+  {
+    ScratchArena arena;
+    const size_t big = ScratchArena::c_minChunk;
+    for (int pass = 0; pass != 3; ++pass)
+      {
+        ScratchArena::Scope scope(arena);
+        for (int i = 0; i != 4; ++i)
+          {
+            char *const p = scope.allocate<char>(big);
+            std::memset(p, i, big);
+            if (!aligned(p)) ++status;
+          }
+      }
+    if (arena.numChunkAlloc() != 4) ++status;  // 3 growing + 1 coalesced
+    if (arena.capacity() < 4*big) ++status;
+    if (arena.highWater() != 4*big) ++status;
+    if (ScratchArena::maxHighWater() < 4*big) ++status;
+    if (verbose)
+      {
+        arena.report(std::cout);
+      }
+  }
+
+  // Temporary FArrayBoxes in the arena of each thread
+  {
+    const Box box(IntVect::Zero, 15*IntVect::Unit);
+    int numErr = 0;
+#pragma omp parallel for reduction(+:numErr)
+    for (int rep = 0; rep < 8; ++rep)
+      {
+        ScratchArena& arena = ScratchArena::local();
+        const int numAlloc = arena.numChunkAlloc();
+        for (int step = 0; step != 4; ++step)
+          {
+            FABSTACKTEMP(fabA, box, 2);
+            FABSTACKTEMP(fabB, box, 1);
+            if (!aligned(fabA.dataPtr()) || !aligned(fabB.dataPtr())) ++numErr;
+            if (arena.inUse() < fabA.sizeBytes() + fabB.sizeBytes())
+              ++numErr;
+            fabA.setVal(0, rep);
+            fabA.setVal(1, step);
+            fabB.setVal(-1.);
+            for (BoxIterator bit(box); bit.ok(); ++bit)
+              {
+                if (fabA(*bit, 0) != rep || fabA(*bit, 1) != step ||
+                    fabB(*bit, 0) != -1.) ++numErr;
+              }
+          }
+        if (arena.inUse() != 0) ++numErr;
+        // Only the first use on a thread allocates
+        if (numAlloc > 0 && arena.numChunkAlloc() != numAlloc) ++numErr;
+      }
+    if (verbose)
+      {
+        std::cout << "Temporary fab errors: " << numErr << std::endl;
+        ScratchArena::local().report(std::cout);
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testScratchArena";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
@@ -0,0 +1,313 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cmath>
+
+#include "BaseFab.H"
+#include "BaseFabMacros.H"
+#include "BoxIterator.H"
+#include "StaticFab.H"
+#include "Stopwatch.H"
+
+// BaseFabs viewed with dimensions fixed at compile time.  Kernels
+// dispatched to StaticFabs are compared to the same kernels on BaseFabs
+// and, with -v, the times are compared.
+
+// Cells in each direction (with 1 ghost) and components as in a D3Q19
+// lattice-Boltzmann patch
+constexpr int c_n0 = 18;
+constexpr int c_n1 = D_SELECT(1, 18, 18);
+constexpr int c_n2 = D_SELECT(1, 1, 18);
+constexpr int c_nf = 19;
+constexpr int c_nu = 2;
+
+using StaticF = StaticFab<Real, c_n0, c_n1, c_n2, c_nf>;
+using ShapeFU = FabDispatch::Shape<c_n0, c_n1, c_n2, c_nf, c_nu>;
+
+// Value stored in a cell
+Real val(const IntVect& a_iv, const int a_icomp)
+{
+  return 1. + 0.01*(D_TERM(a_iv[0], + 2*a_iv[1], + 3*a_iv[2])) +
+    0.1*a_icomp;
+}
+
+// Moments of the components in the interior of a patch (generic on the
+// type of BaseFab)
+template <typename FabF, typename FabU>
+void moments(FabF&& a_f, FabU&& a_u)
+{
+  MD_ARRAY_RESTRICT(arrF, a_f);
+  MD_ARRAY_RESTRICT(arrU, a_u);
+  MD_FABLOOP(a_f, 1, i)
+    {
+      Real rho = 0.;
+      Real mom = 0.;
+      for (int c = 0; c != a_f.ncomp(); ++c)
+        {
+          const Real fc = arrF[MD_IX(i, c)];
+          rho += fc;
+          mom += (c - c_nf/2)*fc;
+        }
+      arrU[MD_IX(i, 0)] = rho;
+      arrU[MD_IX(i, 1)] = mom/rho;
+    }
+}
+
+// Extents of MD_ARRAY are constant expressions for a StaticFab and the
+// array is zero-based
+template <typename Fab>
+bool constantExtents(Fab&& a_fab)
+{
+  MD_ARRAY(arr, a_fab);
+  static_assert(sizeof(*arr) == sizeof(Real)*StaticF::c_compStride,
+                "MD_ARRAY of a StaticFab must have constant extents");
+  const int D_DECL(h0 = c_n0 - 1, h1 = c_n1 - 1, h2 = c_n2 - 1);
+  return &arr[MD_IX(h, c_nf - 1)] == &a_fab(a_fab.box().hiVect(), c_nf - 1);
+}
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Setup
+
+  // Runtime-extent (VLA) arrays of BaseFabs are indexed by cell so the
+  // lower corner keeps those in the bounds of the array for the ghost
+  // cells used here.  StaticFabs with any lower corner are tested below.
+  const IntVect lo(D_DECL(-1, 0, 0));
+  const Box fabBox(lo, lo + IntVect(D_DECL(c_n0 - 1, c_n1 - 1, c_n2 - 1)));
+  Box interior(fabBox);
+  interior.grow(-1);
+  FArrayBox fabF(fabBox, c_nf);
+  for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+    {
+      for (int c = 0; c != c_nf; ++c)
+        {
+          fabF(*bit, c) = val(*bit, c);
+        }
+    }
+
+//--Tests
+
+  // Which BaseFabs can be viewed
+  {
+    int numErr = 0;
+    if (!StaticF::matches(fabF)) ++numErr;
+    FArrayBox fabFewer(fabBox, c_nf - 1);
+    if (StaticF::matches(fabFewer)) ++numErr;
+    Box bigger(fabBox);
+    bigger.growHi(1, 0);
+    FArrayBox fabBigger(bigger, c_nf);
+    if (StaticF::matches(fabBigger)) ++numErr;
+    FArrayBox::setPadStride(true);
+    FArrayBox fabPadded(fabBox, c_nf);
+    FArrayBox::setPadStride(false);
+    if (StaticF::matches(fabPadded) !=
+        (fabPadded.getStride() == fabF.getStride())) ++numErr;
+    BaseFab<Real, LayoutAoS> fabAoS(fabBox, c_nf);
+    if (StaticF::matches(fabAoS)) ++numErr;
+    if (verbose)
+      {
+        std::cout << "Match errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Indexing is the same as the viewed BaseFab
+  {
+    int numErr = 0;
+    StaticF view(fabF);
+    const FArrayBox& cfabF = fabF;
+    const StaticFab<const Real, c_n0, c_n1, c_n2, c_nf> cview(cfabF);
+    if (view.box() != fabBox || view.size() != fabF.size()) ++numErr;
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        for (int c = 0; c != c_nf; ++c)
+          {
+            if (&view(*bit, c) != &fabF(*bit, c) ||
+                &cview(*bit, c) != &fabF(*bit, c)) ++numErr;
+          }
+      }
+    if (!constantExtents(view)) ++numErr;
+    {
+      MD_ARRAY(arr, cview);
+      MD_LAYOUT_ARRAY(larr, cview);
+      int numCell = 0;
+      MD_FABLOOP(cview, 1, i)
+        {
+          const IntVect iv = MD_FABCELL(cview, i);
+          // Compare addresses (a recomputed val() may differ in the last
+          // bit with contracted floating-point operations)
+          if (&arr[MD_IX(i, 3)] != &fabF(iv, 3) ||
+              &larr[MD_IX(i, 3)] != &fabF(iv, 3)) ++numErr;
+          ++numCell;
+        }
+      if (numCell != interior.size()) ++numErr;
+    }
+    if (verbose)
+      {
+        std::cout << "Indexing errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Kernels dispatched to StaticFabs give the same results
+  {
+    int numErr = 0;
+    const auto kernel =
+      [](auto&& a_f, auto&& a_u)
+      {
+        moments(a_f, a_u);
+      };
+    FArrayBox fabU(fabBox, c_nu, 0.);
+    FArrayBox fabURef(fabBox, c_nu, 0.);
+    if (!FabDispatch::apply<ShapeFU>(kernel, fabF, fabU)) ++numErr;
+    moments(fabF, fabURef);
+    for (BoxIterator bit(fabBox); bit.ok(); ++bit)
+      {
+        for (int c = 0; c != c_nu; ++c)
+          {
+            if (std::fabs(fabU(*bit, c) - fabURef(*bit, c)) >
+                1.E-12*std::fabs(fabURef(*bit, c))) ++numErr;
+          }
+      }
+    // Other shapes use the BaseFabs
+    Box smallBox(fabBox);
+    smallBox.growHi(-2, 0);
+    FArrayBox fabFSmall(smallBox, c_nf);
+    fabFSmall.copy(smallBox, fabF);
+    FArrayBox fabUSmall(smallBox, c_nu, 0.);
+    if (FabDispatch::apply<ShapeFU>(kernel, fabFSmall, fabUSmall)) ++numErr;
+    Box smallInterior(smallBox);
+    smallInterior.grow(-1);
+    for (BoxIterator bit(smallInterior); bit.ok(); ++bit)
+      {
+        if (fabUSmall(*bit, 0) != fabURef(*bit, 0)) ++numErr;
+      }
+    // The first shape that matches is used
+    using ShapeSmall = FabDispatch::Shape<c_n0 - 2, c_n1, c_n2, c_nf, c_nu>;
+    fabUSmall.setVal(0.);
+    if (!FabDispatch::apply<ShapeFU, ShapeSmall>(kernel,
+                                                 fabFSmall, fabUSmall))
+      ++numErr;
+    for (BoxIterator bit(smallInterior); bit.ok(); ++bit)
+      {
+        if (std::fabs(fabUSmall(*bit, 0) - fabURef(*bit, 0)) >
+            1.E-12*fabURef(*bit, 0)) ++numErr;
+      }
+
+    if (verbose)
+      {
+        const int numRep = 2000;
+        Stopwatch<> timeStatic;
+        Stopwatch<> timeGeneral;
+        timeStatic.start();
+        for (int rep = 0; rep != numRep; ++rep)
+          {
+            FabDispatch::apply<ShapeFU>(kernel, fabF, fabU);
+          }
+        timeStatic.stop();
+        timeGeneral.start();
+        for (int rep = 0; rep != numRep; ++rep)
+          {
+            moments(fabF, fabURef);
+          }
+        timeGeneral.stop();
+        std::cout << "Time for " << numRep << " patches (s)\n"
+                  << "  StaticFab: " << timeStatic.time() << '\n'
+                  << "  BaseFab  : " << timeGeneral.time() << std::endl;
+        std::cout << "Dispatch errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // Arrays of StaticFabs are zero-based for any lower corner (all
+  // subscripts are within the constant extents)
+  {
+    int numErr = 0;
+    const IntVect los[] = {
+      IntVect(D_DECL(-9, -20, -3)),
+      IntVect(D_DECL(5, 40, 100)),
+      IntVect(D_DECL(-17, 17, 0))
+    };
+    const auto kernel =
+      [](auto&& a_f, auto&& a_u)
+      {
+        moments(a_f, a_u);
+      };
+    for (const IntVect& offsetLo : los)
+      {
+        const Box offsetBox(offsetLo, offsetLo + fabBox.dimensions() -
+                            IntVect::Unit);
+        FArrayBox offsetF(offsetBox, c_nf);
+        for (BoxIterator bit(offsetBox); bit.ok(); ++bit)
+          {
+            for (int c = 0; c != c_nf; ++c)
+              {
+                offsetF(*bit, c) = val(*bit, c);
+              }
+          }
+        FArrayBox offsetU(offsetBox, c_nu, 0.);
+        // Cells and addresses from the loop
+        {
+          StaticF view(offsetF);
+          MD_ARRAY_RESTRICT(arr, view);
+          int numCell = 0;
+          MD_FABLOOP(view, 0, i)
+            {
+              const IntVect iv = MD_FABCELL(view, i);
+              if (!offsetBox.contains(iv) ||
+                  &arr[MD_IX(i, c_nf - 1)] != &offsetF(iv, c_nf - 1))
+                ++numErr;
+              ++numCell;
+            }
+          if (numCell != offsetBox.size()) ++numErr;
+          if (!constantExtents(view)) ++numErr;
+        }
+        // Results of a kernel compared to BaseFab accessors
+        if (!FabDispatch::apply<ShapeFU>(kernel, offsetF, offsetU)) ++numErr;
+        Box offsetInterior(offsetBox);
+        offsetInterior.grow(-1);
+        for (BoxIterator bit(offsetInterior); bit.ok(); ++bit)
+          {
+            Real rho = 0.;
+            Real mom = 0.;
+            for (int c = 0; c != c_nf; ++c)
+              {
+                rho += offsetF(*bit, c);
+                mom += (c - c_nf/2)*offsetF(*bit, c);
+              }
+            if (std::fabs(offsetU(*bit, 0) - rho) > 1.E-12*rho ||
+                std::fabs(offsetU(*bit, 1) - mom/rho) >
+                1.E-12*std::fabs(rho)) ++numErr;
+          }
+        // Views are only dispatched for BaseFabs with the same box
+        Box shiftedBox(offsetBox);
+        shiftedBox.shift(1, 0);
+        FArrayBox shiftedU(shiftedBox, c_nu);
+        if (ShapeFU::matches(offsetF, shiftedU) ||
+            !ShapeFU::matches(offsetF, offsetU)) ++numErr;
+      }
+    if (verbose)
+      {
+        std::cout << "Lower corner errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testStaticFab";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}
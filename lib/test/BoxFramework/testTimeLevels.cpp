@@ -0,0 +1,147 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <utility>
+
+#include "BaseFab.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "TimeLevels.H"
+
+// A ring of LevelData at successive time levels.  Rotating changes the
+// ages of the levels without moving their data and all levels exchange
+// with one Copier.  A three-level scheme is advanced as a check.
+
+using LevelSolData = LevelData<BaseFab<Real> >;
+
+int main(const int argc, const char* argv[])
+{
+  const bool verbose = ((argc == 2) && (std::strcmp(argv[1], "-v") == 0));
+  int status = 0;
+
+//--Setup
+
+  const Box domain(IntVect::Zero, 7*IntVect::Unit);
+  const DisjointBoxLayout dbl(domain, 4*IntVect::Unit);
+
+//--Tests
+
+  // Ages rotate around the ring and the levels stay in place
+  {
+    int numErr = 0;
+    TimeLevels<LevelSolData, 3> u(dbl, 2, 1);
+    if (TimeLevels<LevelSolData, 3>::c_numLevel != 3) ++numErr;
+    const BaseFab<Real>* fabPtr[3];
+    for (int idx = 0; idx != 3; ++idx)
+      {
+        if (u.slot(idx).ncomp() != 2 || u.slot(idx).nghost() != 1) ++numErr;
+        u.slot(idx).setVal((Real)idx);
+        fabPtr[idx] = &u.slot(idx).getLinear(0);
+      }
+    // Age 0 starts at physical index 0 and next is the oldest
+    if (u.index(0) != 0 || u.index(1) != 2 || u.index(2) != 1) ++numErr;
+    if (&u.next() != &u[2] || &u[0] != &u.slot(0)) ++numErr;
+    for (int step = 1; step != 7; ++step)
+      {
+        LevelSolData& newest = u.next();
+        u.rotate();
+        if (&u[0] != &newest) ++numErr;
+        if (u.index(0) != step % 3 || u.index(1) != (step + 2) % 3 ||
+            u.index(2) != (step + 1) % 3) ++numErr;
+      }
+    for (int idx = 0; idx != 3; ++idx)
+      {
+        if (&u.slot(idx).getLinear(0) != fabPtr[idx] ||
+            u.slot(idx).getLinear(0)(IntVect::Zero, 1) != (Real)idx) ++numErr;
+      }
+    // One level is always the newest
+    TimeLevels<LevelSolData, 1> single(dbl, 1, 0);
+    single.rotate();
+    if (&single.next() != &single[0]) ++numErr;
+    // Moving the ring keeps the data and the ages
+    TimeLevels<LevelSolData, 3> moved(std::move(u));
+    if (&moved[0].getLinear(0) != fabPtr[0] || moved.index(0) != 0)
+      ++numErr;
+    if (verbose)
+      {
+        std::cout << "Rotation errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // All levels exchange with the shared Copier
+  {
+    int numErr = 0;
+    TimeLevels<LevelSolData, 2> f(dbl, 1, 1);
+    f.defineCopier(D_TERM(PeriodicX, | PeriodicY, | PeriodicZ));
+    for (int age = 0; age != 2; ++age)
+      {
+        f[age].setVal(-1.);
+        for (DataIterator dit(dbl); dit.ok(); ++dit)
+          {
+            f[age][dit].setValOMP((Real)(age + 1), dbl[dit]);
+          }
+        f.exchange(age);
+        for (DataIterator dit(dbl); dit.ok(); ++dit)
+          {
+            const BaseFab<Real>& fab = f[age][dit];
+            for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+              {
+                if (fab(*bit, 0) != (Real)(age + 1)) ++numErr;
+              }
+          }
+      }
+    if (verbose)
+      {
+        std::cout << "Exchange errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+  // A three-level recurrence, u^{n+1} = 2u^n - u^{n-1}, advances linearly
+  {
+    int numErr = 0;
+    TimeLevels<LevelSolData, 3> u(dbl, 1, 0);
+    u[1].setVal(0.);
+    u[0].setVal(1.);
+    const int numStep = 10;
+    for (int step = 0; step != numStep; ++step)
+      {
+        for (DataIterator dit(dbl); dit.ok(); ++dit)
+          {
+            BaseFab<Real>& unp1 = u.next()[dit];
+            const BaseFab<Real>& un = u[0][dit];
+            const BaseFab<Real>& unm1 = u[1][dit];
+            for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+              {
+                unp1(*bit, 0) = 2.*un(*bit, 0) - unm1(*bit, 0);
+              }
+          }
+        u.rotate();
+      }
+    if (u[0].max(0, 1) != (Real)(numStep + 1) ||
+        u[0].min(0, 1) != (Real)(numStep + 1) ||
+        u[1].max(0, 1) != (Real)numStep) ++numErr;
+    if (verbose)
+      {
+        std::cout << "Recurrence errors: " << numErr << std::endl;
+      }
+    status += numErr;
+  }
+
+//--Output status
+
+  if (verbose)
+    {
+      std::cout << "Status: " << status << std::endl;
+    }
+  const char* const testName = "testTimeLevels";
+  const char* const statLbl[] = {
+    "failed",
+    "passed"
+  };
+  std::cout << std::left << std::setw(40) << testName
+            << statLbl[(status == 0)] << std::endl;
+  return status;
+}